@@ -28,34 +28,43 @@ DECL_MEGA_CAN_SIG("OpenGPIO-0.1.0     ");
 #define CAN_CS  10
 #define CAN_INT 2
 #define CAN_ID  1
-#define CAN_MSG_BUFFER_SIZE 40
+#define CAN_MSG_BUFFER_SIZE 32// power of 2 (queue capacity is rounded down)
+#define CAN_TX_BUFFER_SIZE 8
+#define NUM_FLASH_PAGES 2// one RAM page per flash table so tuning never has to swap pages
 
 #define RT_BCAST_OFFSET PAGE2_FIELD_OFFSET(rtBcast)
 
+// flash tables are burned through a journal (placed right after them)
+#define JOURNAL_NUM_CHUNKS ((PAGE1_SIZE + PAGE2_SIZE) / MEGA_CAN_JOURNAL_CHUNK_SIZE)
+#define JOURNAL_FLASH_OFFSET (PAGE2_FLASH_OFFSET + PAGE2_SIZE)
+#define JOURNAL_NUM_SLOTS 40
+static_assert(JOURNAL_FLASH_OFFSET + MEGA_CAN_JOURNAL_SIZE(JOURNAL_NUM_SLOTS) <= (E2END + 1));
+
 MegaCAN::CAN_Msg can_buff[CAN_MSG_BUFFER_SIZE];
-MegaCAN::ExtDevice gpio(CAN_CS,CAN_ID,CAN_INT,can_buff,CAN_MSG_BUFFER_SIZE,TABLES,NUM_TABLES);
+MegaCAN::CAN_Msg can_tx_buff[CAN_TX_BUFFER_SIZE];
+MegaCAN::FlashPage_t flash_pages[NUM_FLASH_PAGES];
+uint8_t journal_chunk_map[JOURNAL_NUM_CHUNKS];
+MegaCAN::FlashJournal journal(PAGE1_FLASH_OFFSET,JOURNAL_NUM_CHUNKS,journal_chunk_map,JOURNAL_FLASH_OFFSET,JOURNAL_NUM_SLOTS);
+MegaCAN::ExtDevice gpio(CAN_CS,CAN_ID,CAN_INT,can_buff,CAN_MSG_BUFFER_SIZE,TABLES,NUM_TABLES,can_tx_buff,CAN_TX_BUFFER_SIZE,flash_pages,NUM_FLASH_PAGES);
 
 // Scheduler
 Scheduler ts;
 
 // Define ADC mapping flash lookup table utilities
-using ADC_MappingLUT = FlashUtils::FlashLUT<uint16_t, int16_t>;
+// (cached in RAM and reloaded automatically after page 1 is burned)
+using ADC_MappingLUT = FlashUtils::FastFlashLUT<uint16_t, int16_t, ADC_MAPPING_CURVE_N_BINS>;
 ADC_MappingLUT adcCurveA(
   PAGE1_FIELD_OFFSET(adcMappingCurveA_xBins),
-  PAGE1_FIELD_OFFSET(adcMappingCurveA_yBins),
-  ADC_MAPPING_CURVE_N_BINS);
+  PAGE1_FIELD_OFFSET(adcMappingCurveA_yBins));
 ADC_MappingLUT adcCurveB(
   PAGE1_FIELD_OFFSET(adcMappingCurveB_xBins),
-  PAGE1_FIELD_OFFSET(adcMappingCurveB_yBins),
-  ADC_MAPPING_CURVE_N_BINS);
+  PAGE1_FIELD_OFFSET(adcMappingCurveB_yBins));
 ADC_MappingLUT adcCurveC(
   PAGE1_FIELD_OFFSET(adcMappingCurveC_xBins),
-  PAGE1_FIELD_OFFSET(adcMappingCurveC_yBins),
-  ADC_MAPPING_CURVE_N_BINS);
+  PAGE1_FIELD_OFFSET(adcMappingCurveC_yBins));
 ADC_MappingLUT adcCurveD(
   PAGE1_FIELD_OFFSET(adcMappingCurveD_xBins),
-  PAGE1_FIELD_OFFSET(adcMappingCurveD_yBins),
-  ADC_MAPPING_CURVE_N_BINS);
+  PAGE1_FIELD_OFFSET(adcMappingCurveD_yBins));
 
 #define ADC_READY_MASK 0x1000
 volatile uint16_t adcBuff[6];
@@ -91,6 +100,13 @@ setup()
 
   cli();
 
+  // rebuild journaled flash tables before anything reads them
+  journal.begin();
+  if ( ! gpio.setJournal(&journal))
+  {
+    ERROR("journal setup failed! burning flash tables in place");
+  }
+
   // MCP2515 configuration
   gpio.init();
   pinMode(CAN_INT, INPUT_PULLUP);// Configuring pin for CAN interrupt input
@@ -139,12 +155,12 @@ loop()
     }
   }
 
-  // perform real-time data transmission
+  // perform real-time data transmission (less of it while the bus has errors)
+  MegaCAN::RT_Bcast.setRateDivisor(gpio.optionalTxDivisor());
   MegaCAN::RT_Bcast.execute();
 
   // update status0
   outPC.status0.bits.needsBurn = gpio.needsBurn();
-  outPC.status0.bits.flashDataLost = gpio.flashDataLost();
   outPC.status0.bits.currFlashTable = gpio.currFlashTable();
 
   // update CAN status registers
@@ -162,7 +178,7 @@ applyNewADC(
   uint8_t adcIdx)
 {
   uint16_t *outPC_ADC_Values = &outPC.adc0;
-  uint8_t mappingCtrlVal = EEPROM.read(PAGE1_FIELD_OFFSET(adc0MappingCtrl) + adcIdx);
+  uint8_t mappingCtrlVal = FlashUtils::readByte(PAGE1_FIELD_OFFSET(adc0MappingCtrl) + adcIdx);
   ADC_MappingControl_T *mappingCtrl = (ADC_MappingControl_T *)(&mappingCtrlVal);
 
   if (mappingCtrl->bits.enabled)
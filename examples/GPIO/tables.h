@@ -33,8 +33,7 @@ struct OutPC_T
     struct Status0Bits_T
     {
       uint8_t needsBurn      : 1;
-      uint8_t flashDataLost  : 1;
-      uint8_t reserved       : 2;
+      uint8_t reserved       : 3;
       uint8_t currFlashTable : 4;
     } bits;
     uint8_t value;
@@ -102,8 +101,8 @@ extern OutPC_T outPC;
 #define NUM_TABLES 3
 static const MegaCAN::TableDescriptor_t TABLES[NUM_TABLES] = {
   {&outPC,            sizeof(OutPC_T), MegaCAN::TableType_E::eRam  , -1                }, // table 0
-  {MegaCAN::tempPage, sizeof(Page1_T), MegaCAN::TableType_E::eFlash, PAGE1_FLASH_OFFSET}, // table 1
-  {MegaCAN::tempPage, sizeof(Page2_T), MegaCAN::TableType_E::eFlash, PAGE2_FLASH_OFFSET}  // table 2
+  {nullptr,          sizeof(Page1_T), MegaCAN::TableType_E::eFlash, PAGE1_FLASH_OFFSET}, // table 1
+  {nullptr,          sizeof(Page2_T), MegaCAN::TableType_E::eFlash, PAGE2_FLASH_OFFSET}  // table 2
 };
 
 #endif
\ No newline at end of file
@@ -3,7 +3,7 @@
 #include <FlashUtils.h>
 #include <logging_impl_lite.h>
 
-#include "RealtimeDataListener.h"
+#include <MegaCAN_RealtimeDataListener.h>
 
 // Required for MegaCAN library
 DECL_MEGA_CAN_REV("OpenGPIO");
@@ -16,9 +16,10 @@ DECL_MEGA_CAN_SIG("OpenGPIO-0.1.0     ");
 #define CAN_MSG_BUFFER_SIZE 1// only 1 because we handle 11bit frames immediately
 
 MegaCAN::CAN_Msg canBuff[CAN_MSG_BUFFER_SIZE];
-RealtimeDataListener rtdl(CAN_CS,CAN_ID,CAN_INT,canBuff,CAN_MSG_BUFFER_SIZE);
+MegaCAN::RealtimeDataListener rtdl(CAN_CS,CAN_ID,CAN_INT,canBuff,CAN_MSG_BUFFER_SIZE);
 
 void canISR();
+void printEngineVars(const MegaCAN::RT_Signal &sig, int32_t seconds, void *arg);
 
 void
 setup()
@@ -29,6 +30,8 @@ setup()
 
   // MCP2515 configuration
   rtdl.init();
+  // print engine variables every time the ECU's seconds counter ticks
+  rtdl.watchSignal(MegaCAN::RtSig::seconds,0,printEngineVars);
   pinMode(CAN_INT, INPUT_PULLUP);// Configuring pin for CAN interrupt input
   attachInterrupt(digitalPinToInterrupt(CAN_INT), canISR, LOW);
 
@@ -38,56 +41,77 @@ setup()
   INFO("setup complete!");
 }
 
-uint16_t lastDisplaySeconds = 0;
+#if MEGA_CAN_RX_TIMESTAMPS
+bool wasEcuFresh = false;
+#endif
 
 void
 loop()
 {
   rtdl.handle();
 
-  // print engine variables every second
-  const uint16_t ecuSeconds = rtdl.data().m0.seconds();
-  if (lastDisplaySeconds != ecuSeconds)
+#if MEGA_CAN_RX_TIMESTAMPS
+  // msg00 is broadcast continuously, so it going stale means the ECU is gone
+  const bool ecuFresh = rtdl.isFresh(0);
+  if (wasEcuFresh && ! ecuFresh)
   {
-    INFO("=========================================================");
-    INFO(
-      "msg00: seconds %d, pw1 %d, pw2 %d, rpm %d",
-      ecuSeconds,
-      rtdl.data().m0.pw1().whole(),
-      rtdl.data().m0.pw2().whole(),
-      rtdl.data().m0.rpm());
-    INFO(
-      "msg01: adv_deg %d, squirt %d, engine %02x, afrtgt1 %d, afrtgt2 %d, wbo2_en1 %d, wbo2_en2 %d",
-      rtdl.data().m1.adv_deg().whole(),
-      rtdl.data().m1.squirt(),
-      rtdl.data().m1.engine(),
-      rtdl.data().m1.afrtgt1(),
-      rtdl.data().m1.afrtgt2(),
-      rtdl.data().m1.wbo2_en1(),
-      rtdl.data().m1.wbo2_en2());
-    INFO(
-      "msg02: baro %d, map %d, mat %d, clt %d",
-      rtdl.data().m2.baro().whole(),
-      rtdl.data().m2.map().whole(),
-      rtdl.data().m2.mat().whole(),
-      rtdl.data().m2.clt().whole());
-    INFO(
-      "msg03: tps %d, batt %d, afr1_old %d, afr2_old %d",
-      rtdl.data().m3.tps().whole(),
-      rtdl.data().m3.batt().whole(),
-      rtdl.data().m3.afr1_old().whole(),
-      rtdl.data().m3.afr2_old().whole());
-    INFO(
-      "msg10: status1 %02x, status2 %02x, status3 %02x, status4 %02x, status5 %04x, status6 %02x, status7 %02x",
-      rtdl.data().m10.status1(),
-      rtdl.data().m10.status2(),
-      rtdl.data().m10.status3(),
-      rtdl.data().m10.status4(),
-      rtdl.data().m10.status5(),
-      rtdl.data().m10.status6(),
-      rtdl.data().m10.status7());
-    lastDisplaySeconds = ecuSeconds;
+    WARN("ECU data is stale!");
   }
+  wasEcuFresh = ecuFresh;
+#endif
+}
+
+// called from rtdl.handle() when the ECU's seconds counter changes
+void
+printEngineVars(
+  const MegaCAN::RT_Signal &sig,
+  int32_t seconds,
+  void *arg)
+{
+  // read() copies each message without it being torn by the CAN interrupt
+  MegaCAN::RtMsg00_t m0 = rtdl.read(rtdl.data().m0);
+  MegaCAN::RtMsg01_t m1 = rtdl.read(rtdl.data().m1);
+  MegaCAN::RtMsg02_t m2 = rtdl.read(rtdl.data().m2);
+  MegaCAN::RtMsg03_t m3 = rtdl.read(rtdl.data().m3);
+  MegaCAN::RtMsg10_t m10 = rtdl.read(rtdl.data().m10);
+
+  INFO("=========================================================");
+  INFO(
+    "msg00: seconds %d, pw1 %d, pw2 %d, rpm %d",
+    (uint16_t)(seconds),
+    m0.pw1().whole(),
+    m0.pw2().whole(),
+    m0.rpm());
+  INFO(
+    "msg01: adv_deg %d, squirt %d, engine %02x, afrtgt1 %d, afrtgt2 %d, wbo2_en1 %d, wbo2_en2 %d",
+    m1.adv_deg().whole(),
+    m1.squirt(),
+    m1.engine(),
+    m1.afrtgt1(),
+    m1.afrtgt2(),
+    m1.wbo2_en1(),
+    m1.wbo2_en2());
+  INFO(
+    "msg02: baro %d, map %d, mat %d, clt %d",
+    m2.baro().whole(),
+    m2.map().whole(),
+    m2.mat().whole(),
+    m2.clt().whole());
+  INFO(
+    "msg03: tps %d, batt %d, afr1_old %d, afr2_old %d",
+    m3.tps().whole(),
+    m3.batt().whole(),
+    m3.afr1_old().whole(),
+    m3.afr2_old().whole());
+  INFO(
+    "msg10: status1 %02x, status2 %02x, status3 %02x, status4 %02x, status5 %04x, status6 %02x, status7 %02x",
+    m10.status1(),
+    m10.status2(),
+    m10.status3(),
+    m10.status4(),
+    m10.status5(),
+    m10.status6(),
+    m10.status7());
 }
 
 // external interrupt service routine for CAN message on MCP2515
@@ -0,0 +1,67 @@
+#include <EEPROM.h>
+#include <EndianUtils.h>
+#include <FlashUtils.h>
+#include <logging_impl_lite.h>
+
+#include <MegaCAN_RealtimeSubsetListener.h>
+
+// Required for MegaCAN library
+DECL_MEGA_CAN_REV("OpenGPIO");
+DECL_MEGA_CAN_SIG("OpenGPIO-0.1.0     ");
+
+// CAN related variables
+#define CAN_CS  10
+#define CAN_INT 2
+#define CAN_ID  0// don't care since we're only listening
+#define CAN_MSG_BUFFER_SIZE 1// only 1 because we handle 11bit frames immediately
+
+// only msg00 (rpm) and msg02 (map) are stored, and only their frames pass
+// the hardware filters
+MegaCAN::CAN_Msg canBuff[CAN_MSG_BUFFER_SIZE];
+MegaCAN::RealtimeSubsetListener<0,2> rtsl(CAN_CS,CAN_ID,CAN_INT,canBuff,CAN_MSG_BUFFER_SIZE);
+
+void canISR();
+
+void
+setup()
+{
+  setupLogging(115200);
+
+  cli();
+
+  // MCP2515 configuration
+  rtsl.init();
+  pinMode(CAN_INT, INPUT_PULLUP);// Configuring pin for CAN interrupt input
+  attachInterrupt(digitalPinToInterrupt(CAN_INT), canISR, LOW);
+
+  // enabled interrupts
+  sei();
+  
+  INFO("setup complete!");
+}
+
+void
+loop()
+{
+  rtsl.handle();
+
+  // only print when the ECU actually sent new values. take both dirty bits
+  // so a change to msg02 isn't left pending when msg00 changed too
+  const bool m0Dirty = rtsl.takeDirty<0>();
+  const bool m2Dirty = rtsl.takeDirty<2>();
+  if (m0Dirty || m2Dirty)
+  {
+    MegaCAN::RtMsg00_t m0 = rtsl.read<0>();
+    MegaCAN::RtMsg02_t m2 = rtsl.read<2>();
+    INFO(
+      "rpm %d, map %d",
+      m0.rpm(),
+      m2.map().whole());
+  }
+}
+
+// external interrupt service routine for CAN message on MCP2515
+void canISR()
+{
+  rtsl.interrupt();
+}
@@ -0,0 +1,48 @@
+#include "CrcUtils.h"
+
+namespace CrcUtils
+{
+
+  uint32_t
+  crc32Raw(
+    uint32_t        reg,
+    const uint8_t * data,
+    uint16_t        len)
+  {
+    while (len--)
+    {
+      reg = crc32RawByte(reg, *data++);
+    }
+    return reg;
+  }
+
+  uint32_t
+  crc32RawZeros(
+    uint32_t reg,
+    uint16_t n)
+  {
+    while (n--)
+    {
+      reg = crc32RawByte(reg, 0x00);
+    }
+    return reg;
+  }
+
+  uint8_t
+  crc8(
+    const uint8_t * data,
+    uint8_t         len)
+  {
+    uint8_t reg = 0x00;
+    while (len--)
+    {
+      reg ^= *data++;
+      for (uint8_t b=0; b<8; b++)
+      {
+        reg = (reg & 0x80) ? ((reg << 1) ^ 0x07) : (reg << 1);
+      }
+    }
+    return reg;
+  }
+
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <stdint.h>
+
+namespace CrcUtils
+{
+
+/**
+ * Clocks a single byte through a raw CRC-32 register (IEEE 802.3,
+ * reflected polynomial 0xEDB88320). No initial value or final xor is
+ * applied, which keeps the register linear so CRCs can be patched
+ * incrementally: crc(M ^ D) = crc(M) ^ raw(D), where D is the xor of the
+ * old and new block contents (zero outside the modified range).
+ */
+inline
+uint32_t
+crc32RawByte(
+  uint32_t      reg,
+  const uint8_t byte)
+{
+  reg ^= byte;
+  for (uint8_t b=0; b<8; b++)
+  {
+    reg = (reg >> 1) ^ (0xEDB88320UL & -(int32_t)(reg & 0x1));
+  }
+  return reg;
+}
+
+/**
+ * Clocks a block of bytes through a raw CRC-32 register.
+ */
+uint32_t
+crc32Raw(
+  uint32_t        reg,
+  const uint8_t * data,
+  uint16_t        len);
+
+/**
+ * Clocks n zero bytes through a raw CRC-32 register.
+ */
+uint32_t
+crc32RawZeros(
+  uint32_t reg,
+  uint16_t n);
+
+/**
+ * Standard CRC-32 of a block of bytes (same as zlib's crc32()).
+ */
+inline
+uint32_t
+crc32(
+  const uint8_t * data,
+  uint16_t        len)
+{
+  return ~crc32Raw(0xFFFFFFFFUL, data, len);
+}
+
+/**
+ * CRC-8 (polynomial 0x07, initial value 0x00) of a block of bytes. Used to
+ * validate small records stored in EEPROM.
+ */
+uint8_t
+crc8(
+  const uint8_t * data,
+  uint8_t         len);
+
+}
@@ -1,16 +1,151 @@
 #include "FlashUtils.h"
 
 #include <Arduino.h>
+#include <avr/eeprom.h>
 
 namespace FlashUtils
 {
+
+  static AddressMapper addressMapper = nullptr;
+  static ByteWriter byteWriter = nullptr;
+
+  // head of the list of all FlashCaches
+  static FlashCache *cacheList = nullptr;
+
+  FlashCache::FlashCache()
+   : next_(cacheList)
+  {
+    cacheList = this;
+  }
+
+  FlashCache::~FlashCache()
+  {
+    for (FlashCache **c=&cacheList; *c; c=&((*c)->next_))
+    {
+      if (*c == this)
+      {
+        *c = next_;
+        break;
+      }
+    }
+  }
+
+  void
+  invalidateCaches(
+    const fsize_t offset,
+    const fsize_t len)
+  {
+    for (FlashCache *c=cacheList; c; c=c->next_)
+    {
+      c->invalidateRange(offset,len);
+    }
+  }
+
+  /**
+   * Holds off the EEPROM ready interrupt (which drives background burns)
+   * and waits for any write in progress, giving the caller exclusive access
+   * to the EEPROM registers.
+   * 
+   * @return
+   * The previous EERIE state to pass back into releaseEEPROM()
+   */
+  static
+  uint8_t
+  acquireEEPROM()
+  {
+    const uint8_t sreg = SREG;
+    cli();
+    const uint8_t eerie = EECR & _BV(EERIE);
+    EECR &= ~_BV(EERIE);
+    SREG = sreg;
+    eeprom_busy_wait();
+    return eerie;
+  }
+
+  static
+  void
+  releaseEEPROM(
+    const uint8_t eerie)
+  {
+    if (eerie)
+    {
+      EECR |= _BV(EERIE);
+    }
+  }
+
+  void
+  setAddressMapper(
+    AddressMapper mapper)
+  {
+    addressMapper = mapper;
+  }
+
+  void
+  setByteWriter(
+    ByteWriter writer)
+  {
+    byteWriter = writer;
+  }
+
+  uint8_t
+  readByte(
+    const fsize_t offset)
+  {
+    const fsize_t addr = (addressMapper ? addressMapper(offset) : offset);
+    const uint8_t eerie = acquireEEPROM();
+    const uint8_t value = eeprom_read_byte((const uint8_t *)(addr));
+    releaseEEPROM(eerie);
+    return value;
+  }
+
+  void
+  readBlock(
+    const fsize_t offset,
+    void        * dst,
+    const fsize_t len)
+  {
+    const uint8_t eerie = acquireEEPROM();
+    if (addressMapper)
+    {
+      // mapped bytes aren't necessarily contiguous
+      uint8_t *dst8 = (uint8_t *)(dst);
+      for (fsize_t i=0; i<len; i++)
+      {
+        dst8[i] = eeprom_read_byte((const uint8_t *)(addressMapper(offset + i)));
+      }
+    }
+    else
+    {
+      eeprom_read_block(dst, (const void *)(offset), len);
+    }
+    releaseEEPROM(eerie);
+  }
+
+  void
+  writeByte(
+    const fsize_t offset,
+    const uint8_t value)
+  {
+    const uint8_t eerie = acquireEEPROM();
+    if (byteWriter)
+    {
+      byteWriter(offset, value);
+    }
+    else
+    {
+      eeprom_write_byte((uint8_t *)(offset), value);
+    }
+    releaseEEPROM(eerie);
+    invalidateCaches(offset,1);
+  }
   
+
   template <>
   uint8_t
   readBE(
     const fsize_t offset)
   {
-    return EEPROM.read(offset);
+    return readByte(offset);
   }
 
   template <>
@@ -18,7 +153,7 @@ namespace FlashUtils
   readBE(
     const fsize_t offset)
   {
-    return EEPROM.read(offset);
+    return readByte(offset);
   }
   
   template <>
@@ -79,7 +214,7 @@ namespace FlashUtils
     const fsize_t offset,
     const uint8_t value)
   {
-    EEPROM.write(offset,value);
+    writeByte(offset,value);
   }
 
   template <>
@@ -88,7 +223,7 @@ namespace FlashUtils
     const fsize_t offset,
     const int8_t  value)
   {
-    EEPROM.write(offset,value);
+    writeByte(offset,value);
   }
   
   template <>
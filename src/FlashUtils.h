@@ -6,19 +6,19 @@
 #include "EndianUtils.h"
 
 // reads a big endian 16bit signed/unsigned word from EEPROM flash
-#define EEPROM_GetBigS16(ADDR) (int16_t)(((uint16_t)(EEPROM.read(ADDR)) << 8) | EEPROM.read(ADDR + 1))
-#define EEPROM_GetBigU16(ADDR) (uint16_t)(((uint16_t)(EEPROM.read(ADDR)) << 8) | EEPROM.read(ADDR + 1))
+#define EEPROM_GetBigS16(ADDR) (int16_t)(((uint16_t)(FlashUtils::readByte(ADDR)) << 8) | FlashUtils::readByte(ADDR + 1))
+#define EEPROM_GetBigU16(ADDR) (uint16_t)(((uint16_t)(FlashUtils::readByte(ADDR)) << 8) | FlashUtils::readByte(ADDR + 1))
 
 // writes a big endian 16bit signed/unsigned word to EEPROM flash
-#define EEPROM_SetBigU16(ADDR,VAL) EEPROM.write(ADDR,(VAL)>>8&0xFF);EEPROM.write(ADDR + 1,(VAL)&0xFF)
+#define EEPROM_SetBigU16(ADDR,VAL) FlashUtils::writeByte(ADDR,(VAL)>>8&0xFF);FlashUtils::writeByte(ADDR + 1,(VAL)&0xFF)
 #define EEPROM_SetBigS16(ADDR,VAL) EEPROM_SetBigU16(ADDR,VAL)
 
 // reads a big endian 32bit signed/unsigned word from EEPROM flash
-#define EEPROM_GetBigS32(ADDR) (int32_t)(((uint32_t)(EEPROM.read(ADDR)) << 24) | ((uint32_t)(EEPROM.read(ADDR + 1)) << 16) | ((uint32_t)(EEPROM.read(ADDR + 2)) << 8) | EEPROM.read(ADDR + 3))
-#define EEPROM_GetBigU32(ADDR) (uint32_t)(((uint32_t)(EEPROM.read(ADDR)) << 24) | ((uint32_t)(EEPROM.read(ADDR + 1)) << 16) | ((uint32_t)(EEPROM.read(ADDR + 2)) << 8) | EEPROM.read(ADDR + 3))
+#define EEPROM_GetBigS32(ADDR) (int32_t)(((uint32_t)(FlashUtils::readByte(ADDR)) << 24) | ((uint32_t)(FlashUtils::readByte(ADDR + 1)) << 16) | ((uint32_t)(FlashUtils::readByte(ADDR + 2)) << 8) | FlashUtils::readByte(ADDR + 3))
+#define EEPROM_GetBigU32(ADDR) (uint32_t)(((uint32_t)(FlashUtils::readByte(ADDR)) << 24) | ((uint32_t)(FlashUtils::readByte(ADDR + 1)) << 16) | ((uint32_t)(FlashUtils::readByte(ADDR + 2)) << 8) | FlashUtils::readByte(ADDR + 3))
 
 // writes a big endian 32bit signed/unsigned word to EEPROM flash
-#define EEPROM_SetBigU32(ADDR,VAL) EEPROM.write(ADDR,(VAL)>>24&0xFF);EEPROM.write(ADDR + 1,(VAL>>16)&0xFF);EEPROM.write(ADDR + 2,(VAL>>8)&0xFF);EEPROM.write(ADDR + 3,(VAL)&0xFF)
+#define EEPROM_SetBigU32(ADDR,VAL) FlashUtils::writeByte(ADDR,(VAL)>>24&0xFF);FlashUtils::writeByte(ADDR + 1,(VAL>>16)&0xFF);FlashUtils::writeByte(ADDR + 2,(VAL>>8)&0xFF);FlashUtils::writeByte(ADDR + 3,(VAL)&0xFF)
 #define EEPROM_SetBigS32(ADDR,VAL) EEPROM_SetBigU32(ADDR,VAL)
 
 // type used to define an address offset into EEPROM flash
@@ -27,6 +27,83 @@ using fsize_t = uint16_t;
 namespace FlashUtils
 {
 
+/**
+ * Maps a flash offset to the EEPROM address that currently holds its data.
+ * Used by storage backends that keep the latest copy of some bytes outside
+ * of their home location (see MegaCAN::FlashJournal).
+ */
+using AddressMapper = fsize_t (*)(const fsize_t offset);
+
+/**
+ * Installs an address mapper that all of the FlashUtils read functions go
+ * through. Pass nullptr to read all offsets from their home location.
+ */
+void
+setAddressMapper(
+  AddressMapper mapper);
+
+/**
+ * Writes a byte on behalf of writeByte(). Used by storage backends that
+ * keep the latest copy of some bytes outside of their home location, so
+ * that writes land wherever reads will look (see MegaCAN::FlashJournal).
+ * Called with the EEPROM ready interrupt held off.
+ */
+using ByteWriter = void (*)(const fsize_t offset, const uint8_t value);
+
+/**
+ * Installs a byte writer that writeByte() (and the EEPROM_Set* macros) go
+ * through. Pass nullptr to write all offsets to their home location.
+ */
+void
+setByteWriter(
+  ByteWriter writer);
+
+/**
+ * Reads a byte from EEPROM flash. Unlike EEPROM.read(), this is safe to
+ * call while a background burn is in progress (see MegaCAN::ExtDevice).
+ * The EEPROM ready interrupt is held off for the duration of the read, so
+ * it may block until the byte currently being written completes.
+ * 
+ * @param[in] offset
+ * The flash byte offset to read from
+ */
+uint8_t
+readByte(
+  const fsize_t offset);
+
+/**
+ * Reads a block of bytes from EEPROM flash. The EEPROM ready interrupt is
+ * only held off once for the whole block.
+ * 
+ * @param[in] offset
+ * The flash byte offset to begin reading from
+ * 
+ * @param[out] dst
+ * Where to store the read bytes
+ * 
+ * @param[in] len
+ * The number of bytes to read
+ */
+void
+readBlock(
+  const fsize_t offset,
+  void        * dst,
+  const fsize_t len);
+
+/**
+ * Writes a byte to EEPROM flash. Like readByte(), this is safe to call
+ * while a background burn is in progress. The byte goes through the byte
+ * writer if one is installed (see setByteWriter()), so that later reads
+ * through the address mapper see it.
+ * 
+ * @param[in] offset
+ * The flash byte offset to write to
+ */
+void
+writeByte(
+  const fsize_t offset,
+  const uint8_t value);
+
 /**
  * Reads a trivial type from flash that was stored in big endian format.
  * The read value is convert into native litte endian format.
@@ -39,6 +116,89 @@ T
 readBE(
   const fsize_t offset);
 
+/**
+ * Base class for RAM caches of data that's stored in EEPROM flash. Every
+ * cache registers itself in a global list so that they can all be
+ * invalidated when a range of flash gets rewritten (see invalidateCaches()).
+ */
+class FlashCache
+{
+public:
+  FlashCache();
+
+  virtual
+  ~FlashCache();
+
+  // caches are registered by address, so they can't be copied
+  FlashCache(const FlashCache &) = delete;
+  FlashCache &operator=(const FlashCache &) = delete;
+
+  // forces the cache to be reloaded from flash on its next access
+  void
+  invalidate()
+  {
+    valid_ = false;
+  }
+
+  bool
+  valid() const
+  {
+    return valid_;
+  }
+
+protected:
+  /**
+   * @return
+   * True if any of the cached data was loaded from the flash range
+   */
+  virtual
+  bool
+  overlaps(
+    const fsize_t offset,
+    const fsize_t len) const = 0;
+
+  /**
+   * Called by invalidateCaches() for each rewritten range. By default the
+   * whole cache is invalidated if any of its data came from the range.
+   */
+  virtual
+  void
+  invalidateRange(
+    const fsize_t offset,
+    const fsize_t len)
+  {
+    if (overlaps(offset,len))
+    {
+      invalidate();
+    }
+  }
+
+  // true once the cache has been loaded
+  mutable bool valid_ = false;
+
+private:
+  FlashCache *next_ = nullptr;
+
+  friend void invalidateCaches(const fsize_t offset, const fsize_t len);
+
+};
+
+/**
+ * Invalidates all the FlashCaches that hold data loaded from a range of
+ * flash. Called by MegaCAN::ExtDevice once a table has been burned, and
+ * by writeByte().
+ * 
+ * @param[in] offset
+ * The flash byte offset of the start of the range
+ * 
+ * @param[in] len
+ * The number of bytes in the range
+ */
+void
+invalidateCaches(
+  const fsize_t offset,
+  const fsize_t len);
+
 /**
  * Writes a trivial type into flash, converting it from little endian
  * into big endian prior to storage.
@@ -199,4 +359,584 @@ private:
 
 };
 
+/**
+ * 2D lookup table (ie. a TunerStudio "table" like RPM x MAP) with bilinear
+ * interpolation. Z values are stored row major, one row per y bin:
+ * 
+ *   z[yIdx * nX + xIdx]
+ * 
+ * which matches how TunerStudio lays out a [nY x nX] table array.
+ * 
+ * The last (x, y) cell is remembered, so lookups with slowly changing inputs
+ * only have to probe the previous cell (or its neighbor) rather than search
+ * both axes. Note that this makes lerp() unsafe to share between the main
+ * loop and an ISR.
+ */
+template <typename X_T, typename Y_T, typename Z_T>
+class LUT2D
+{
+public:
+  static_assert(sizeof(X_T) <= 2 && sizeof(Y_T) <= 2 && sizeof(Z_T) <= 2,
+    "LUT2D only supports 8/16bit bins");
+
+  using x_t = X_T;
+  using y_t = Y_T;
+  using z_t = Z_T;
+
+  static constexpr uint8_t FRAC_BITS = 14;
+  static constexpr int32_t FRAC_ONE = 1L << FRAC_BITS;
+  static constexpr int32_t FRAC_HALF = FRAC_ONE / 2;
+
+  LUT2D() = default;
+
+  LUT2D(
+    const uint8_t nX,
+    const uint8_t nY)
+   : nX_(nX)
+   , nY_(nY)
+  {}
+
+  uint8_t nX() const {return nX_;}
+  uint8_t nY() const {return nY_;}
+
+  virtual
+  X_T
+  getX(
+    const uint8_t idx) const = 0;
+
+  virtual
+  Y_T
+  getY(
+    const uint8_t idx) const = 0;
+
+  virtual
+  Z_T
+  getZ(
+    const uint8_t xIdx,
+    const uint8_t yIdx) const = 0;
+
+  Z_T
+  lerp(
+    const X_T x,
+    const Y_T y) const
+  {
+    if (nX_ == 0u || nY_ == 0u)
+    {
+      return 0;
+    }
+
+    // fractions within the cell are Q14 (0 to 16384). bins are at most 16bit
+    // so a Z delta times a fraction always fits within an int32_t
+    uint16_t fx = 0;
+    uint16_t fy = 0;
+    const uint8_t xi = findCell(
+      [this](const uint8_t i) -> int32_t {return getX(i);},
+      nX_, x, lastX_, fx);
+    const uint8_t yi = findCell(
+      [this](const uint8_t i) -> int32_t {return getY(i);},
+      nY_, y, lastY_, fy);
+    const uint8_t xi1 = (nX_ > 1u ? xi + 1u : xi);
+    const uint8_t yi1 = (nY_ > 1u ? yi + 1u : yi);
+
+    // interpolate along x within both rows, then along y between them
+    const int32_t z00 = getZ(xi, yi);
+    const int32_t z10 = getZ(xi1, yi);
+    const int32_t z01 = getZ(xi, yi1);
+    const int32_t z11 = getZ(xi1, yi1);
+    const int32_t r0 = z00 + (((z10 - z00) * fx + FRAC_HALF) >> FRAC_BITS);
+    const int32_t r1 = z01 + (((z11 - z01) * fx + FRAC_HALF) >> FRAC_BITS);
+    return static_cast<Z_T>(r0 + (((r1 - r0) * fy + FRAC_HALF) >> FRAC_BITS));
+  }
+
+private:
+  /**
+   * Finds the cell along an axis that contains value (clamped to the
+   * axis' limits), starting with the hint from the previous lookup.
+   * 
+   * @return
+   * The index of the cell's low bin. frac is set to value's Q14 position
+   * within the cell, and hint is updated to the cell.
+   */
+  template <typename GET_T, typename V_T>
+  static
+  uint8_t
+  findCell(
+    GET_T      get,
+    uint8_t    n,
+    const V_T  value,
+    uint8_t  & hint,
+    uint16_t & frac)
+  {
+    frac = 0;
+    if (n < 2u || value <= get(0))
+    {
+      hint = 0;
+      return 0;
+    }
+    else if (value >= get(n - 1u))
+    {
+      hint = n - 2u;
+      frac = FRAC_ONE;
+      return hint;
+    }
+
+    uint8_t i = (hint < (n - 1u) ? hint : n - 2u);
+    int32_t lo = get(i);
+    int32_t hi = get(i + 1u);
+    if (value >= hi && (i + 2u) < n && value < get(i + 2u))
+    {
+      // moved into the next cell
+      i++;
+      lo = hi;
+      hi = get(i + 1u);
+    }
+    else if (value < lo && i > 0u && value >= get(i - 1u))
+    {
+      // moved into the previous cell
+      i--;
+      hi = lo;
+      lo = get(i);
+    }
+    else if ( ! (lo <= value && value < hi))
+    {
+      // binary search for cell where get(loIdx) <= value < get(hiIdx)
+      uint8_t loIdx = 0;
+      uint8_t hiIdx = n - 1u;
+      while ((uint8_t)(hiIdx - loIdx) > 1u)
+      {
+        const uint8_t mid = (loIdx + hiIdx) >> 1;
+        if (value < get(mid))
+        {
+          hiIdx = mid;
+        }
+        else
+        {
+          loIdx = mid;
+        }
+      }
+      i = loIdx;
+      lo = get(i);
+      hi = get(i + 1u);
+    }
+
+    hint = i;
+    frac = ((uint32_t)(value - lo) << FRAC_BITS) / (uint32_t)(hi - lo);
+    return i;
+  }
+
+private:
+  uint8_t nX_ = 0u;
+  uint8_t nY_ = 0u;
+
+  // cell found by the previous lookup
+  mutable uint8_t lastX_ = 0u;
+  mutable uint8_t lastY_ = 0u;
+
+};
+
+template <typename X_T, typename Y_T, typename Z_T>
+class FlashLUT2D : public LUT2D<X_T, Y_T, Z_T>
+{
+public:
+  using lut_t = LUT2D<X_T, Y_T, Z_T>;
+  static constexpr fsize_t x_size = sizeof(X_T);
+  static constexpr fsize_t y_size = sizeof(Y_T);
+  static constexpr fsize_t z_size = sizeof(Z_T);
+
+  FlashLUT2D() = default;
+
+  FlashLUT2D(
+    const fsize_t xOffset,
+    const fsize_t yOffset,
+    const fsize_t zOffset,
+    const uint8_t nX,
+    const uint8_t nY)
+   : lut_t(nX, nY)
+   , xOffset_(xOffset)
+   , yOffset_(yOffset)
+   , zOffset_(zOffset)
+  {}
+
+  X_T
+  getX(
+    const uint8_t idx) const override final
+  {
+    return readBE<X_T>(xOffset_ + idx * x_size);
+  }
+
+  Y_T
+  getY(
+    const uint8_t idx) const override final
+  {
+    return readBE<Y_T>(yOffset_ + idx * y_size);
+  }
+
+  Z_T
+  getZ(
+    const uint8_t xIdx,
+    const uint8_t yIdx) const override final
+  {
+    return readBE<Z_T>(zOffset_ + (yIdx * lut_t::nX() + xIdx) * z_size);
+  }
+
+private:
+  fsize_t xOffset_ = 0u;
+  fsize_t yOffset_ = 0u;
+  fsize_t zOffset_ = 0u;
+
+};
+
+template <typename X_T, typename Y_T, typename Z_T>
+class RAM_LUT2D : public LUT2D<X_T, Y_T, Z_T>
+{
+public:
+  using lut_t = LUT2D<X_T, Y_T, Z_T>;
+
+  RAM_LUT2D() = default;
+
+  RAM_LUT2D(
+    const X_T   * xBins,
+    const Y_T   * yBins,
+    const Z_T   * zBins,
+    const uint8_t nX,
+    const uint8_t nY)
+   : lut_t(nX, nY)
+   , xBins_(xBins)
+   , yBins_(yBins)
+   , zBins_(zBins)
+  {}
+
+  X_T
+  getX(
+    const uint8_t idx) const override final
+  {
+    return EndianUtils::getBE(xBins_[idx]);
+  }
+
+  Y_T
+  getY(
+    const uint8_t idx) const override final
+  {
+    return EndianUtils::getBE(yBins_[idx]);
+  }
+
+  Z_T
+  getZ(
+    const uint8_t xIdx,
+    const uint8_t yIdx) const override final
+  {
+    return EndianUtils::getBE(zBins_[yIdx * lut_t::nX() + xIdx]);
+  }
+
+private:
+  const X_T * xBins_ = nullptr;
+  const Y_T * yBins_ = nullptr;
+  const Z_T * zBins_ = nullptr;
+
+};
+
+/**
+ * A FlashLUT that keeps a RAM copy of its bins (already converted from big
+ * endian). The copy is loaded on first use and reloaded after the bins'
+ * flash range has been invalidated (ie. the owning table was burned).
+ */
+template <typename X_T, typename Y_T, uint8_t N_BINS>
+class CachedFlashLUT : public LUT<X_T, Y_T>, public FlashCache
+{
+public:
+  using lut_t = LUT<X_T, Y_T>;
+  static constexpr fsize_t x_size = sizeof(X_T);
+  static constexpr fsize_t y_size = sizeof(Y_T);
+
+  CachedFlashLUT(
+    const fsize_t xOffset,
+    const fsize_t yOffset,
+    const uint8_t nBins = N_BINS)
+   : lut_t(nBins < N_BINS ? nBins : N_BINS)
+   , xOffset_(xOffset)
+   , yOffset_(yOffset)
+  {}
+
+  X_T
+  getX(
+    const uint8_t idx) const override final
+  {
+    load();
+    return xBins_[idx];
+  }
+  
+  Y_T
+  getY(
+    const uint8_t idx) const override final
+  {
+    load();
+    return yBins_[idx];
+  }
+
+protected:
+  bool
+  overlaps(
+    const fsize_t offset,
+    const fsize_t len) const override
+  {
+    const fsize_t n = lut_t::nBins();
+    return (offset < (xOffset_ + n * x_size) && xOffset_ < (offset + len)) ||
+      (offset < (yOffset_ + n * y_size) && yOffset_ < (offset + len));
+  }
+
+private:
+  void
+  load() const
+  {
+    if (valid_)
+    {
+      return;
+    }
+
+    for (uint8_t i=0; i<lut_t::nBins(); i++)
+    {
+      xBins_[i] = readBE<X_T>(xOffset_ + i * x_size);
+      yBins_[i] = readBE<Y_T>(yOffset_ + i * y_size);
+    }
+    valid_ = true;
+  }
+
+private:
+  fsize_t xOffset_ = 0u;
+  fsize_t yOffset_ = 0u;
+  mutable X_T xBins_[N_BINS];
+  mutable Y_T yBins_[N_BINS];
+
+};
+
+/**
+ * Statically sized LUT without any virtual calls on the lookup path. The
+ * DERIVED class provides the bin storage (CRTP) by implementing:
+ * 
+ *   X_T readX(const uint8_t idx) const;
+ *   Y_T readY(const uint8_t idx) const;
+ * 
+ * which are only called by load(). load() copies the bins into RAM and
+ * precomputes each segment's slope in Q16 fixed point, so lerp() is just a
+ * binary search plus two small multiplies (no division). Results are within
+ * 1 LSB of the exact interpolation. DERIVED can also hide prepare() to load
+ * lazily.
+ */
+template <typename DERIVED, typename X_T, typename Y_T, uint8_t N_BINS>
+class FastLUT
+{
+public:
+  static_assert(N_BINS >= 2, "FastLUT needs at least 2 bins");
+  static_assert(sizeof(X_T) <= 2 && sizeof(Y_T) <= 2, "FastLUT only supports 8/16bit bins");
+
+  using x_t = X_T;
+  using y_t = Y_T;
+
+  static constexpr uint8_t nBins() {return N_BINS;}
+
+  X_T
+  getX(
+    const uint8_t idx) const
+  {
+    derived()->prepare();
+    return xBins_[idx];
+  }
+
+  Y_T
+  getY(
+    const uint8_t idx) const
+  {
+    derived()->prepare();
+    return yBins_[idx];
+  }
+
+  // (re)loads the bins from DERIVED's storage and precomputes the slopes
+  void
+  load() const
+  {
+    for (uint8_t i=0; i<N_BINS; i++)
+    {
+      xBins_[i] = derived()->readX(i);
+      yBins_[i] = derived()->readY(i);
+    }
+
+    for (uint8_t i=0; i<(N_BINS - 1); i++)
+    {
+      const int32_t span = (int32_t)(xBins_[i+1]) - xBins_[i];
+      const int32_t dy = (int32_t)(yBins_[i+1]) - yBins_[i];
+      int32_t slope = 0;// Q16
+      if (span > 0)
+      {
+        // round to nearest (only done at load time, so 64bit is fine)
+        const int64_t num = (int64_t)(dy) * 65536 + (dy >= 0 ? span / 2 : -span / 2);
+        slope = (int32_t)(num / span);
+      }
+      slopeInt_[i] = slope >> 16;// floor
+      slopeFrac_[i] = slope & 0xFFFF;
+    }
+  }
+
+  Y_T
+  lerp(
+    const X_T value) const
+  {
+    derived()->prepare();
+
+    // handle case where value is beyond the x-axis limits
+    if (value <= xBins_[0])
+    {
+      return yBins_[0];
+    }
+    else if (value >= xBins_[N_BINS - 1u])
+    {
+      return yBins_[N_BINS - 1u];
+    }
+
+    // find segment where xBins_[lo] <= value < xBins_[hi]
+    uint8_t lo = 0;
+    uint8_t hi = N_BINS - 1u;
+    while ((uint8_t)(hi - lo) > 1u)
+    {
+      const uint8_t mid = (lo + hi) >> 1;
+      if (value < xBins_[mid])
+      {
+        hi = mid;
+      }
+      else
+      {
+        lo = mid;
+      }
+    }
+
+    // y = y0 + dx * slope, where slope = slopeInt + slopeFrac / 2^16
+    const uint16_t dx = value - xBins_[lo];
+    const int32_t dy = slopeInt_[lo] * (int32_t)(dx) + (int32_t)(((uint32_t)(slopeFrac_[lo]) * dx + 0x8000) >> 16);
+    return static_cast<Y_T>(yBins_[lo] + dy);
+  }
+
+protected:
+  // default is to require an explicit load()
+  void prepare() const {}
+
+  mutable X_T xBins_[N_BINS];
+  mutable Y_T yBins_[N_BINS];
+  mutable int32_t slopeInt_[N_BINS - 1u];
+  mutable uint16_t slopeFrac_[N_BINS - 1u];
+
+private:
+  const DERIVED *
+  derived() const
+  {
+    return static_cast<const DERIVED *>(this);
+  }
+
+};
+
+/**
+ * FastLUT with bins stored big endian in EEPROM flash. The bins are loaded
+ * on first use, and reloaded after their flash range has been invalidated
+ * (ie. the owning table was burned).
+ */
+template <typename X_T, typename Y_T, uint8_t N_BINS>
+class FastFlashLUT
+ : public FastLUT<FastFlashLUT<X_T, Y_T, N_BINS>, X_T, Y_T, N_BINS>
+ , public FlashCache
+{
+public:
+  using lut_t = FastLUT<FastFlashLUT<X_T, Y_T, N_BINS>, X_T, Y_T, N_BINS>;
+  static constexpr fsize_t x_size = sizeof(X_T);
+  static constexpr fsize_t y_size = sizeof(Y_T);
+
+  FastFlashLUT(
+    const fsize_t xOffset,
+    const fsize_t yOffset)
+   : xOffset_(xOffset)
+   , yOffset_(yOffset)
+  {}
+
+protected:
+  bool
+  overlaps(
+    const fsize_t offset,
+    const fsize_t len) const override
+  {
+    return (offset < (xOffset_ + N_BINS * x_size) && xOffset_ < (offset + len)) ||
+      (offset < (yOffset_ + N_BINS * y_size) && yOffset_ < (offset + len));
+  }
+
+private:
+  friend lut_t;
+
+  X_T
+  readX(
+    const uint8_t idx) const
+  {
+    return readBE<X_T>(xOffset_ + idx * x_size);
+  }
+
+  Y_T
+  readY(
+    const uint8_t idx) const
+  {
+    return readBE<Y_T>(yOffset_ + idx * y_size);
+  }
+
+  void
+  prepare() const
+  {
+    if ( ! valid_)
+    {
+      lut_t::load();
+      valid_ = true;
+    }
+  }
+
+private:
+  fsize_t xOffset_ = 0u;
+  fsize_t yOffset_ = 0u;
+
+};
+
+/**
+ * FastLUT with bins stored big endian in RAM. Call load() after the bins
+ * are modified.
+ */
+template <typename X_T, typename Y_T, uint8_t N_BINS>
+class FastRAM_LUT : public FastLUT<FastRAM_LUT<X_T, Y_T, N_BINS>, X_T, Y_T, N_BINS>
+{
+public:
+  using lut_t = FastLUT<FastRAM_LUT<X_T, Y_T, N_BINS>, X_T, Y_T, N_BINS>;
+
+  FastRAM_LUT(
+    const X_T * xBins,
+    const Y_T * yBins)
+   : xSrc_(xBins)
+   , ySrc_(yBins)
+  {
+    lut_t::load();
+  }
+
+private:
+  friend lut_t;
+
+  X_T
+  readX(
+    const uint8_t idx) const
+  {
+    return EndianUtils::getBE(xSrc_[idx]);
+  }
+
+  Y_T
+  readY(
+    const uint8_t idx) const
+  {
+    return EndianUtils::getBE(ySrc_[idx]);
+  }
+
+private:
+  const X_T * xSrc_ = nullptr;
+  const Y_T * ySrc_ = nullptr;
+
+};
+
 }
@@ -25,6 +25,8 @@
 
 #define TABLE_NO_REV 14
 #define TABLE_NO_SIG 15
+// read-only CAN telemetry (see CAN_TelemetryTable_t)
+#define TABLE_NO_TELEMETRY 31
 
 #define MAX_REVISION_BYTES 60
 #define MAX_SIGNATURE_BYTES 20
@@ -34,6 +36,11 @@
 #define GET_MSG_PROT_MYVAROFFSET(data8_ptr) ((uint16_t)((data8_ptr)[3] >> 5) | ((uint16_t)((data8_ptr)[2]) << 3))
 #define GET_MSG_PROT_VARBYT(data8_ptr)      ((data8_ptr)[3] & 0xf)
 
+// defines for accessing MSG_CRC data field (table to CRC is in the header)
+// the CRC32 is returned as a 4 byte big endian MSG_RSP
+#define GET_MSG_CRC_MYVARBLK(data8_ptr)     ((data8_ptr)[1])
+#define GET_MSG_CRC_MYVAROFFSET(data8_ptr)  ((uint16_t)((data8_ptr)[3] >> 5) | ((uint16_t)((data8_ptr)[2]) << 3))
+
 struct MS_HDR_t{
   uint8_t          : 2;
   uint8_t   tableH : 1;
@@ -109,6 +116,26 @@ namespace MegaCAN
     VAL_T frac() {return (value * MULT) % DIV;}
     float flt() {return ((float)(value) * MULT) / DIV;}
   };
+
+  // locates a raw (unscaled) value within a realtime message. offsets and
+  // sizes match Megasquirt_CAN_Broadcast.csv (see RtSig below for all of them)
+  struct RT_Signal
+  {
+    // the realtime message number the value is in
+    uint8_t msgNum;
+
+    // byte offset of the value within the message
+    uint8_t offset;
+
+    // size of the value in bytes (1, 2 or 4). multi-byte values are big endian
+    uint8_t size;
+
+    bool isSigned;
+
+    // returns the raw value of the signal from the message's 8 data bytes
+    // (see MegaCAN_RealtimeDataListener.cpp)
+    int32_t decode(const uint8_t *msgData) const;
+  };
   
   struct RtMsg00_t
   {
@@ -1554,4 +1581,370 @@ namespace MegaCAN
     MsgAttr<uint16_t,1,10> gps_course() const {return MSG_GET_U16(data,6);}
   };
 
+  // maps a realtime message number to its struct (ie. RtMsg<2>::type is RtMsg02_t)
+  template<uint8_t N> struct RtMsg;
+  template<> struct RtMsg<0> {using type = RtMsg00_t;};
+  template<> struct RtMsg<1> {using type = RtMsg01_t;};
+  template<> struct RtMsg<2> {using type = RtMsg02_t;};
+  template<> struct RtMsg<3> {using type = RtMsg03_t;};
+  template<> struct RtMsg<4> {using type = RtMsg04_t;};
+  template<> struct RtMsg<5> {using type = RtMsg05_t;};
+  template<> struct RtMsg<6> {using type = RtMsg06_t;};
+  template<> struct RtMsg<7> {using type = RtMsg07_t;};
+  template<> struct RtMsg<8> {using type = RtMsg08_t;};
+  template<> struct RtMsg<9> {using type = RtMsg09_t;};
+  template<> struct RtMsg<10> {using type = RtMsg10_t;};
+  template<> struct RtMsg<11> {using type = RtMsg11_t;};
+  template<> struct RtMsg<12> {using type = RtMsg12_t;};
+  template<> struct RtMsg<13> {using type = RtMsg13_t;};
+  template<> struct RtMsg<14> {using type = RtMsg14_t;};
+  template<> struct RtMsg<15> {using type = RtMsg15_t;};
+  template<> struct RtMsg<16> {using type = RtMsg16_t;};
+  template<> struct RtMsg<17> {using type = RtMsg17_t;};
+  template<> struct RtMsg<18> {using type = RtMsg18_t;};
+  template<> struct RtMsg<19> {using type = RtMsg19_t;};
+  template<> struct RtMsg<20> {using type = RtMsg20_t;};
+  template<> struct RtMsg<21> {using type = RtMsg21_t;};
+  template<> struct RtMsg<22> {using type = RtMsg22_t;};
+  template<> struct RtMsg<23> {using type = RtMsg23_t;};
+  template<> struct RtMsg<24> {using type = RtMsg24_t;};
+  template<> struct RtMsg<25> {using type = RtMsg25_t;};
+  template<> struct RtMsg<26> {using type = RtMsg26_t;};
+  template<> struct RtMsg<27> {using type = RtMsg27_t;};
+  template<> struct RtMsg<28> {using type = RtMsg28_t;};
+  template<> struct RtMsg<29> {using type = RtMsg29_t;};
+  template<> struct RtMsg<30> {using type = RtMsg30_t;};
+  template<> struct RtMsg<31> {using type = RtMsg31_t;};
+  template<> struct RtMsg<32> {using type = RtMsg32_t;};
+  template<> struct RtMsg<33> {using type = RtMsg33_t;};
+  template<> struct RtMsg<34> {using type = RtMsg34_t;};
+  template<> struct RtMsg<35> {using type = RtMsg35_t;};
+  template<> struct RtMsg<36> {using type = RtMsg36_t;};
+  template<> struct RtMsg<37> {using type = RtMsg37_t;};
+  template<> struct RtMsg<38> {using type = RtMsg38_t;};
+  template<> struct RtMsg<39> {using type = RtMsg39_t;};
+  template<> struct RtMsg<40> {using type = RtMsg40_t;};
+  template<> struct RtMsg<41> {using type = RtMsg41_t;};
+  template<> struct RtMsg<42> {using type = RtMsg42_t;};
+  template<> struct RtMsg<43> {using type = RtMsg43_t;};
+  template<> struct RtMsg<44> {using type = RtMsg44_t;};
+  template<> struct RtMsg<45> {using type = RtMsg45_t;};
+  template<> struct RtMsg<46> {using type = RtMsg46_t;};
+  template<> struct RtMsg<47> {using type = RtMsg47_t;};
+  template<> struct RtMsg<48> {using type = RtMsg48_t;};
+  template<> struct RtMsg<49> {using type = RtMsg49_t;};
+  template<> struct RtMsg<50> {using type = RtMsg50_t;};
+  template<> struct RtMsg<51> {using type = RtMsg51_t;};
+  template<> struct RtMsg<52> {using type = RtMsg52_t;};
+  template<> struct RtMsg<53> {using type = RtMsg53_t;};
+  template<> struct RtMsg<54> {using type = RtMsg54_t;};
+  template<> struct RtMsg<55> {using type = RtMsg55_t;};
+  template<> struct RtMsg<56> {using type = RtMsg56_t;};
+  template<> struct RtMsg<57> {using type = RtMsg57_t;};
+  template<> struct RtMsg<58> {using type = RtMsg58_t;};
+  template<> struct RtMsg<59> {using type = RtMsg59_t;};
+  template<> struct RtMsg<60> {using type = RtMsg60_t;};
+  template<> struct RtMsg<61> {using type = RtMsg61_t;};
+  template<> struct RtMsg<62> {using type = RtMsg62_t;};
+
+  // location of every realtime signal (ie. for RealtimeDataListener::watchSignal())
+  namespace RtSig
+  {
+    constexpr RT_Signal seconds = {0,0,2,false};
+    constexpr RT_Signal pw1 = {0,2,2,false};
+    constexpr RT_Signal pw2 = {0,4,2,false};
+    constexpr RT_Signal rpm = {0,6,2,false};
+    constexpr RT_Signal adv_deg = {1,0,2,true};
+    constexpr RT_Signal squirt = {1,2,1,false};
+    constexpr RT_Signal engine = {1,3,1,false};
+    constexpr RT_Signal afrtgt1 = {1,4,1,false};
+    constexpr RT_Signal afrtgt2 = {1,5,1,false};
+    constexpr RT_Signal wbo2_en1 = {1,6,1,false};
+    constexpr RT_Signal wbo2_en2 = {1,7,1,false};
+    constexpr RT_Signal baro = {2,0,2,true};
+    constexpr RT_Signal map = {2,2,2,true};
+    constexpr RT_Signal mat = {2,4,2,true};
+    constexpr RT_Signal clt = {2,6,2,true};
+    constexpr RT_Signal tps = {3,0,2,true};
+    constexpr RT_Signal batt = {3,2,2,true};
+    constexpr RT_Signal afr1_old = {3,4,2,true};
+    constexpr RT_Signal afr2_old = {3,6,2,true};
+    constexpr RT_Signal knock = {4,0,2,true};
+    constexpr RT_Signal egocor1 = {4,2,2,true};
+    constexpr RT_Signal egocor2 = {4,4,2,true};
+    constexpr RT_Signal aircor = {4,6,2,true};
+    constexpr RT_Signal warmcor = {5,0,2,true};
+    constexpr RT_Signal tpsaccel = {5,2,2,true};
+    constexpr RT_Signal tpsfuelcut = {5,4,2,true};
+    constexpr RT_Signal barocor = {5,6,2,true};
+    constexpr RT_Signal totalcor = {6,0,2,true};
+    constexpr RT_Signal ve1 = {6,2,2,true};
+    constexpr RT_Signal ve2 = {6,4,2,true};
+    constexpr RT_Signal iacstep = {6,6,2,true};
+    constexpr RT_Signal cold_adv_deg = {7,0,2,true};
+    constexpr RT_Signal TPSdot = {7,2,2,true};
+    constexpr RT_Signal MAPdot = {7,4,2,true};
+    constexpr RT_Signal RPMdot = {7,6,2,true};
+    constexpr RT_Signal MAFload = {8,0,2,true};
+    constexpr RT_Signal fuelload = {8,2,2,true};
+    constexpr RT_Signal fuelcor = {8,4,2,true};
+    constexpr RT_Signal MAF = {8,6,2,true};
+    constexpr RT_Signal egoV1 = {9,0,2,true};
+    constexpr RT_Signal egoV2 = {9,2,2,true};
+    constexpr RT_Signal dwell = {9,4,2,false};
+    constexpr RT_Signal dwell_trl = {9,6,2,false};
+    constexpr RT_Signal status1 = {10,0,1,false};
+    constexpr RT_Signal status2 = {10,1,1,false};
+    constexpr RT_Signal status3 = {10,2,1,false};
+    constexpr RT_Signal status4 = {10,3,1,false};
+    constexpr RT_Signal status5 = {10,4,2,true};
+    constexpr RT_Signal status6 = {10,6,1,false};
+    constexpr RT_Signal status7 = {10,7,1,false};
+    constexpr RT_Signal fuelload2 = {11,0,2,true};
+    constexpr RT_Signal ignload = {11,2,2,true};
+    constexpr RT_Signal ignload2 = {11,4,2,true};
+    constexpr RT_Signal airtemp = {11,6,2,true};
+    constexpr RT_Signal wallfuel1 = {12,0,4,true};
+    constexpr RT_Signal wallfuel2 = {12,4,4,true};
+    constexpr RT_Signal sensors1 = {13,0,2,true};
+    constexpr RT_Signal sensors2 = {13,2,2,true};
+    constexpr RT_Signal sensors3 = {13,4,2,true};
+    constexpr RT_Signal sensors4 = {13,6,2,true};
+    constexpr RT_Signal sensors5 = {14,0,2,true};
+    constexpr RT_Signal sensors6 = {14,2,2,true};
+    constexpr RT_Signal sensors7 = {14,4,2,true};
+    constexpr RT_Signal sensors8 = {14,6,2,true};
+    constexpr RT_Signal sensors9 = {15,0,2,true};
+    constexpr RT_Signal sensors10 = {15,2,2,true};
+    constexpr RT_Signal sensors11 = {15,4,2,true};
+    constexpr RT_Signal sensors12 = {15,6,2,true};
+    constexpr RT_Signal sensors13 = {16,0,2,true};
+    constexpr RT_Signal sensors14 = {16,2,2,true};
+    constexpr RT_Signal sensors15 = {16,4,2,true};
+    constexpr RT_Signal sensors16 = {16,6,2,true};
+    constexpr RT_Signal boost_targ_1 = {17,0,2,true};
+    constexpr RT_Signal boost_targ_2 = {17,2,2,true};
+    constexpr RT_Signal boostduty = {17,4,1,false};
+    constexpr RT_Signal boostduty2 = {17,5,1,false};
+    constexpr RT_Signal maf_volts = {17,6,2,true};
+    constexpr RT_Signal pwseq1 = {18,0,2,true};
+    constexpr RT_Signal pwseq2 = {18,2,2,true};
+    constexpr RT_Signal pwseq3 = {18,4,2,true};
+    constexpr RT_Signal pwseq4 = {18,6,2,true};
+    constexpr RT_Signal pwseq5 = {19,0,2,true};
+    constexpr RT_Signal pwseq6 = {19,2,2,true};
+    constexpr RT_Signal pwseq7 = {19,4,2,true};
+    constexpr RT_Signal pwseq8 = {19,6,2,true};
+    constexpr RT_Signal pwseq9 = {20,0,2,true};
+    constexpr RT_Signal pwseq10 = {20,2,2,true};
+    constexpr RT_Signal pwseq11 = {20,4,2,true};
+    constexpr RT_Signal pwseq12 = {20,6,2,true};
+    constexpr RT_Signal pwseq13 = {21,0,2,true};
+    constexpr RT_Signal pwseq14 = {21,2,2,true};
+    constexpr RT_Signal pwseq15 = {21,4,2,true};
+    constexpr RT_Signal pwseq16 = {21,6,2,true};
+    constexpr RT_Signal egt1 = {22,0,2,true};
+    constexpr RT_Signal egt2 = {22,2,2,true};
+    constexpr RT_Signal egt3 = {22,4,2,true};
+    constexpr RT_Signal egt4 = {22,6,2,true};
+    constexpr RT_Signal egt5 = {23,0,2,true};
+    constexpr RT_Signal egt6 = {23,2,2,true};
+    constexpr RT_Signal egt7 = {23,4,2,true};
+    constexpr RT_Signal egt8 = {23,6,2,true};
+    constexpr RT_Signal egt9 = {24,0,2,true};
+    constexpr RT_Signal egt10 = {24,2,2,true};
+    constexpr RT_Signal egt11 = {24,4,2,true};
+    constexpr RT_Signal egt12 = {24,6,2,true};
+    constexpr RT_Signal egt13 = {25,0,2,true};
+    constexpr RT_Signal egt14 = {25,2,2,true};
+    constexpr RT_Signal egt15 = {25,4,2,true};
+    constexpr RT_Signal egt16 = {25,6,2,true};
+    constexpr RT_Signal nitrous1_duty = {26,0,1,false};
+    constexpr RT_Signal nitrous2_duty = {26,1,1,false};
+    constexpr RT_Signal nitrous_timer_ou = {26,2,2,false};
+    constexpr RT_Signal n2o_addfuel = {26,4,2,true};
+    constexpr RT_Signal n2o_retard = {26,6,2,true};
+    constexpr RT_Signal canpwmin1 = {27,0,2,true};
+    constexpr RT_Signal canpwmin2 = {27,2,2,true};
+    constexpr RT_Signal canpwmin3 = {27,4,2,true};
+    constexpr RT_Signal canpwmin4 = {27,6,2,true};
+    constexpr RT_Signal cl_idle_targ_rpm = {28,0,2,false};
+    constexpr RT_Signal tpsadc = {28,2,2,true};
+    constexpr RT_Signal eaeload = {28,4,2,true};
+    constexpr RT_Signal afrload = {28,6,2,true};
+    constexpr RT_Signal EAEfcor1 = {29,0,2,false};
+    constexpr RT_Signal EAEfcor2 = {29,2,2,false};
+    constexpr RT_Signal VSS1dot = {29,4,2,true};
+    constexpr RT_Signal VSS2dot = {29,6,2,true};
+    constexpr RT_Signal accelx = {30,0,2,true};
+    constexpr RT_Signal accely = {30,2,2,true};
+    constexpr RT_Signal accelz = {30,4,2,true};
+    constexpr RT_Signal stream_level = {30,6,1,false};
+    constexpr RT_Signal water_duty = {30,7,1,false};
+    constexpr RT_Signal AFR1 = {31,0,1,false};
+    constexpr RT_Signal AFR2 = {31,1,1,false};
+    constexpr RT_Signal AFR3 = {31,2,1,false};
+    constexpr RT_Signal AFR4 = {31,3,1,false};
+    constexpr RT_Signal AFR5 = {31,4,1,false};
+    constexpr RT_Signal AFR6 = {31,5,1,false};
+    constexpr RT_Signal AFR7 = {31,6,1,false};
+    constexpr RT_Signal AFR8 = {31,7,1,false};
+    constexpr RT_Signal AFR9 = {32,0,1,false};
+    constexpr RT_Signal AFR10 = {32,1,1,false};
+    constexpr RT_Signal AFR11 = {32,2,1,false};
+    constexpr RT_Signal AFR12 = {32,3,1,false};
+    constexpr RT_Signal AFR13 = {32,4,1,false};
+    constexpr RT_Signal AFR14 = {32,5,1,false};
+    constexpr RT_Signal AFR15 = {32,6,1,false};
+    constexpr RT_Signal AFR16 = {32,7,1,false};
+    constexpr RT_Signal duty_pwm1 = {33,0,1,false};
+    constexpr RT_Signal duty_pwm2 = {33,1,1,false};
+    constexpr RT_Signal duty_pwm3 = {33,2,1,false};
+    constexpr RT_Signal duty_pwm4 = {33,3,1,false};
+    constexpr RT_Signal duty_pwm5 = {33,4,1,false};
+    constexpr RT_Signal duty_pwm6 = {33,5,1,false};
+    constexpr RT_Signal gear = {33,6,1,true};
+    constexpr RT_Signal status8 = {33,7,1,false};
+    constexpr RT_Signal EGOv1 = {34,0,2,true};
+    constexpr RT_Signal EGOv2 = {34,2,2,true};
+    constexpr RT_Signal EGOv3 = {34,4,2,true};
+    constexpr RT_Signal EGOv4 = {34,6,2,true};
+    constexpr RT_Signal EGOv5 = {35,0,2,true};
+    constexpr RT_Signal EGOv6 = {35,2,2,true};
+    constexpr RT_Signal EGOv7 = {35,4,2,true};
+    constexpr RT_Signal EGOv8 = {35,6,2,true};
+    constexpr RT_Signal EGOv9 = {36,0,2,true};
+    constexpr RT_Signal EGOv10 = {36,2,2,true};
+    constexpr RT_Signal EGOv11 = {36,4,2,true};
+    constexpr RT_Signal EGOv12 = {36,6,2,true};
+    constexpr RT_Signal EGOv13 = {37,0,2,true};
+    constexpr RT_Signal EGOv14 = {37,2,2,true};
+    constexpr RT_Signal EGOv15 = {37,4,2,true};
+    constexpr RT_Signal EGOv16 = {37,6,2,true};
+    constexpr RT_Signal EGOcor1 = {38,0,2,true};
+    constexpr RT_Signal EGOcor2 = {38,2,2,true};
+    constexpr RT_Signal EGOcor3 = {38,4,2,true};
+    constexpr RT_Signal EGOcor4 = {38,6,2,true};
+    constexpr RT_Signal EGOcor5 = {39,0,2,true};
+    constexpr RT_Signal EGOcor6 = {39,2,2,true};
+    constexpr RT_Signal EGOcor7 = {39,4,2,true};
+    constexpr RT_Signal EGOcor8 = {39,6,2,true};
+    constexpr RT_Signal EGOcor9 = {40,0,2,true};
+    constexpr RT_Signal EGOcor10 = {40,2,2,true};
+    constexpr RT_Signal EGOcor11 = {40,4,2,true};
+    constexpr RT_Signal EGOcor12 = {40,6,2,true};
+    constexpr RT_Signal EGOcor13 = {41,0,2,true};
+    constexpr RT_Signal EGOcor14 = {41,2,2,true};
+    constexpr RT_Signal EGOcor15 = {41,4,2,true};
+    constexpr RT_Signal EGOcor16 = {41,6,2,true};
+    constexpr RT_Signal VSS1 = {42,0,2,false};
+    constexpr RT_Signal VSS2 = {42,2,2,false};
+    constexpr RT_Signal VSS3 = {42,4,2,false};
+    constexpr RT_Signal VSS4 = {42,6,2,false};
+    constexpr RT_Signal synccnt = {43,0,1,false};
+    constexpr RT_Signal syncreason = {43,1,1,false};
+    constexpr RT_Signal sd_filenum = {43,2,2,false};
+    constexpr RT_Signal sd_error = {43,4,1,false};
+    constexpr RT_Signal sd_phase = {43,5,1,false};
+    constexpr RT_Signal sd_status = {43,6,1,false};
+    constexpr RT_Signal timing_err = {43,7,1,true};
+    constexpr RT_Signal vvt_ang1 = {44,0,2,true};
+    constexpr RT_Signal vvt_ang2 = {44,2,2,true};
+    constexpr RT_Signal vvt_ang3 = {44,4,2,true};
+    constexpr RT_Signal vvt_ang4 = {44,6,2,true};
+    constexpr RT_Signal vvt_target1 = {45,0,2,true};
+    constexpr RT_Signal vvt_target2 = {45,2,2,true};
+    constexpr RT_Signal vvt_target3 = {45,4,2,true};
+    constexpr RT_Signal vvt_target4 = {45,6,2,true};
+    constexpr RT_Signal vvt_duty1 = {46,0,1,false};
+    constexpr RT_Signal vvt_duty2 = {46,1,1,false};
+    constexpr RT_Signal vvt_duty3 = {46,2,1,false};
+    constexpr RT_Signal vvt_duty4 = {46,3,1,false};
+    constexpr RT_Signal inj_timing_pri = {46,4,2,true};
+    constexpr RT_Signal inj_timing_sec = {46,6,2,true};
+    constexpr RT_Signal fuel_pct = {47,0,2,true};
+    constexpr RT_Signal tps_accel = {47,2,2,true};
+    constexpr RT_Signal SS1 = {47,4,2,false};
+    constexpr RT_Signal SS2 = {47,6,2,false};
+    constexpr RT_Signal knock_cyl1 = {48,0,1,false};
+    constexpr RT_Signal knock_cyl2 = {48,1,1,false};
+    constexpr RT_Signal knock_cyl3 = {48,2,1,false};
+    constexpr RT_Signal knock_cyl4 = {48,3,1,false};
+    constexpr RT_Signal knock_cyl5 = {48,4,1,false};
+    constexpr RT_Signal knock_cyl6 = {48,5,1,false};
+    constexpr RT_Signal knock_cyl7 = {48,6,1,false};
+    constexpr RT_Signal knock_cyl8 = {48,7,1,false};
+    constexpr RT_Signal knock_cyl9 = {49,0,1,false};
+    constexpr RT_Signal knock_cyl10 = {49,1,1,false};
+    constexpr RT_Signal knock_cyl11 = {49,2,1,false};
+    constexpr RT_Signal knock_cyl12 = {49,3,1,false};
+    constexpr RT_Signal knock_cyl13 = {49,4,1,false};
+    constexpr RT_Signal knock_cyl14 = {49,5,1,false};
+    constexpr RT_Signal knock_cyl15 = {49,6,1,false};
+    constexpr RT_Signal knock_cyl16 = {49,7,1,false};
+    constexpr RT_Signal map_accel = {50,0,2,true};
+    constexpr RT_Signal total_accel = {50,2,2,true};
+    constexpr RT_Signal launch_timer = {50,5,2,false};
+    constexpr RT_Signal launch_retard = {50,6,2,true};
+    constexpr RT_Signal porta = {51,0,1,false};
+    constexpr RT_Signal portb = {51,1,1,false};
+    constexpr RT_Signal porteh = {51,2,1,false};
+    constexpr RT_Signal portk = {51,3,1,false};
+    constexpr RT_Signal portmj = {51,4,1,false};
+    constexpr RT_Signal portp = {51,5,1,false};
+    constexpr RT_Signal portt = {51,6,1,false};
+    constexpr RT_Signal cel_errorcode = {51,7,1,false};
+    constexpr RT_Signal canin1 = {52,0,1,false};
+    constexpr RT_Signal canin2 = {52,1,1,false};
+    constexpr RT_Signal canout = {52,2,1,false};
+    constexpr RT_Signal knk_rtd = {52,3,1,false};
+    constexpr RT_Signal fuelflow = {52,4,2,false};
+    constexpr RT_Signal fuelcons = {52,6,2,false};
+    constexpr RT_Signal fuel_press1 = {53,0,2,true};
+    constexpr RT_Signal fuel_press2 = {53,2,2,true};
+    constexpr RT_Signal fuel_temp1 = {53,4,2,true};
+    constexpr RT_Signal fuel_temp2 = {53,6,2,true};
+    constexpr RT_Signal batt_cur = {54,0,2,true};
+    constexpr RT_Signal cel_status = {54,2,2,false};
+    constexpr RT_Signal fp_duty = {54,4,1,false};
+    constexpr RT_Signal alt_duty = {54,5,1,false};
+    constexpr RT_Signal load_duty = {54,6,1,false};
+    constexpr RT_Signal alt_targv = {54,7,1,false};
+    constexpr RT_Signal looptime = {55,0,2,false};
+    constexpr RT_Signal fueltemp_cor = {55,2,2,false};
+    constexpr RT_Signal fuelpress_cor = {55,4,2,false};
+    constexpr RT_Signal ltt_cor = {55,6,1,true};
+    constexpr RT_Signal tc_retard = {56,0,2,true};
+    constexpr RT_Signal cel_retard = {56,2,2,true};
+    constexpr RT_Signal fc_retard = {56,4,2,true};
+    constexpr RT_Signal als_addfuel = {56,6,2,true};
+    constexpr RT_Signal base_advance = {57,0,2,true};
+    constexpr RT_Signal idle_cor_advance = {57,2,2,true};
+    constexpr RT_Signal mat_retard = {57,4,2,true};
+    constexpr RT_Signal flex_advance = {57,6,2,true};
+    constexpr RT_Signal adv1 = {58,0,2,true};
+    constexpr RT_Signal adv2 = {58,2,2,true};
+    constexpr RT_Signal adv3 = {58,4,2,true};
+    constexpr RT_Signal adv4 = {58,6,2,true};
+    constexpr RT_Signal revlim_retard = {59,0,2,true};
+    constexpr RT_Signal als_timing = {59,2,2,true};
+    constexpr RT_Signal ext_advance = {59,4,2,true};
+    constexpr RT_Signal deadtime1 = {59,6,2,true};
+    constexpr RT_Signal launch_timing = {60,0,2,true};
+    constexpr RT_Signal step3_timing = {60,2,2,true};
+    constexpr RT_Signal vsslaunch_retard = {60,4,2,true};
+    constexpr RT_Signal cel_status2 = {60,6,2,false};
+    constexpr RT_Signal gps_latdeg = {61,0,1,true};
+    constexpr RT_Signal gps_latmin = {61,1,1,false};
+    constexpr RT_Signal gps_latmmin = {61,2,2,false};
+    constexpr RT_Signal gps_londeg = {61,4,1,false};
+    constexpr RT_Signal gps_lonmin = {61,5,1,false};
+    constexpr RT_Signal gps_lonmmin = {61,6,2,false};
+    constexpr RT_Signal gps_outstatus = {62,0,1,false};
+    constexpr RT_Signal gps_altk = {62,1,1,true};
+    constexpr RT_Signal gps_altm = {62,2,2,false};
+    constexpr RT_Signal gps_speed = {62,4,2,false};
+    constexpr RT_Signal gps_course = {62,6,2,false};
+  }
+
 }
@@ -5,9 +5,46 @@
 
 #define LOG_CAN_TRAFFIC 0// set to 1 to log CAN traffic to UART
 
+#if MEGA_CAN_TELEMETRY
+	#define TELEMETRY(CALL) telemetry_.CALL
+#else
+	#define TELEMETRY(CALL)
+#endif
+
 namespace MegaCAN
 {
 
+// EIMSK bit of each of the Arduino core's external interrupt numbers (see
+// digitalPinToInterrupt() and the core's WInterrupts.c)
+#if defined(__AVR_ATmega1280__) || defined(__AVR_ATmega2560__)
+	static const uint8_t EXT_INT_BITS[] = {INT4,INT5,INT0,INT1,INT2,INT3};
+#elif defined(__AVR_ATmega32U4__)
+	static const uint8_t EXT_INT_BITS[] = {INT0,INT1,INT2,INT3,INT6};
+#else
+	static const uint8_t EXT_INT_BITS[] = {INT0,INT1};
+#endif
+
+#if MEGA_CAN_TELEMETRY
+	// TCNT0 ticks since 'start', for use within an ISR. timer0's overflow
+	// isn't serviced until the ISR returns, so a raised TOV0 means TCNT0
+	// wrapped while we ran (unless it was already raised on entry). only one
+	// wrap can be seen, so telemetry counts long durations as overruns.
+	static uint16_t
+	isrTicksSince(
+		const uint8_t start,
+		const bool startOvf)
+	{
+		// read the flag first. a wrap after it shows up as TCNT0 going backwards
+		const bool ovf = TIFR0 & _BV(TOV0);
+		const uint8_t now = TCNT0;
+		if (now < start || (ovf && ! startOvf))
+		{
+			return 256 + now - start;
+		}
+		return now - start;
+	}
+#endif
+
 #if LOG_CAN_TRAFFIC
 	// "0x12345678 | len 4 | 00 00 00 00 00 00 00 00 | ........ |"
 	char __canMsgBuff[64];
@@ -50,26 +87,38 @@ void mega_can_rx0_ovr(MCP_CAN *can, void *varg)
 {
 	MegaCAN::Device *mcd = (MegaCAN::Device*)varg;
 	INC_ERROR_COUNTER(mcd->canHW_Rx0_OverflowCount_);
+#if MEGA_CAN_TELEMETRY
+	mcd->telemetry_.onEvent(CAN_TELEM_HW_RX_OVERFLOW);
+#endif
 }
 
 void mega_can_rx1_ovr(MCP_CAN *can, void *varg)
 {
 	MegaCAN::Device *mcd = (MegaCAN::Device*)varg;
 	INC_ERROR_COUNTER(mcd->canHW_Rx1_OverflowCount_);
+#if MEGA_CAN_TELEMETRY
+	mcd->telemetry_.onEvent(CAN_TELEM_HW_RX_OVERFLOW);
+#endif
 }
 
 void mega_can_tx_bo(MCP_CAN *can, void *varg)
 {
+	MegaCAN::Device *mcd = (MegaCAN::Device*)varg;
+	mcd->raiseErrorState(CAN_ERR_STATE_BUS_OFF);
 	ERROR("TXBO");
 }
 
 void mega_can_tx_ep(MCP_CAN *can, void *varg, uint8_t tec)
 {
+	MegaCAN::Device *mcd = (MegaCAN::Device*)varg;
+	mcd->raiseErrorState(CAN_ERR_STATE_PASSIVE);
 	ERROR("TXEP (%d)",tec);
 }
 
 void mega_can_rx_ep(MCP_CAN *can, void *varg, uint8_t rec)
 {
+	MegaCAN::Device *mcd = (MegaCAN::Device*)varg;
+	mcd->raiseErrorState(CAN_ERR_STATE_PASSIVE);
 	ERROR("RXEP (%d)",rec);
 }
 
@@ -83,6 +132,15 @@ void mega_can_rx_war(MCP_CAN *can, void *varg, uint8_t rec)
 	ERROR("RXWAR (%d)",rec);
 }
 
+// EWARN is set in every degraded state, so this sees every counter update
+void mega_can_e_warn(MCP_CAN *can, void *varg, uint8_t rec, uint8_t tec)
+{
+	MegaCAN::Device *mcd = (MegaCAN::Device*)varg;
+	mcd->raiseErrorState(CAN_ERR_STATE_WARNING);
+	mcd->peakTEC_ = (tec > mcd->peakTEC_ ? tec : mcd->peakTEC_);
+	mcd->peakREC_ = (rec > mcd->peakREC_ ? rec : mcd->peakREC_);
+}
+
 static struct MCP_ErrorHandlers megaCAN_ErrHandlers{
 	.rx0_ovr = mega_can_rx0_ovr,
 	.rx1_ovr = mega_can_rx1_ovr,
@@ -91,7 +149,7 @@ static struct MCP_ErrorHandlers megaCAN_ErrHandlers{
 	.rx_ep   = mega_can_rx_ep,
 	.tx_war  = mega_can_tx_war,
 	.rx_war  = mega_can_rx_war,
-	.e_warn  = NULL
+	.e_warn  = mega_can_e_warn
 };
 
 Device::Device(
@@ -99,13 +157,29 @@ Device::Device(
 		uint8_t myId,
 		uint8_t intPin,
 		CAN_Msg *buff,
-		uint8_t buffSize)
+		uint8_t buffSize,
+		CAN_Msg *txBuff,
+		uint8_t txBuffSize)
 	: can_(cs)
 	, myID_(myId)
 	, intPin_(intPin)
 	, queue_(buff,buffSize)
+	, stdQueue_(nullptr,0)
+	, txQueue_(txBuff,txBuffSize)
+	, txBusyMask_(0x0)
+	, txPrio_(0)
 	, canStatus_(0x0)
+	, canTxCompleteCount_(0)
+	, canTxFailCount_(0)
+#if MEGA_CAN_RX_TIMESTAMPS
+	, rxStamp_(0)
+#endif
+	, errState_(CAN_ERR_STATE_ACTIVE)
+	, errStateTime_(0)
+	, errPollTime_(0)
+	, busOffBackoffMs_(CAN_BUS_OFF_MIN_BACKOFF_MS)
 	, numSimReqDropsLeft_(0)
+	, numBurnAcks_(0)
 {
 	resetErrorCounters();
 	setupOptions();
@@ -135,6 +209,14 @@ Device::init()
 	 */
 	applyCanFilters(&can_);
 
+	// feed transmit buffers from the TX complete interrupts
+	txQueue_.clear();
+	txBusyMask_ = 0x0;
+	can_.setTxInterrupts(txQueue_.capacity() > 0);
+
+	// EFLG is only read when the MCP2515 raises ERRIF
+	can_.setErrorInterrupts(true);
+
 	// set the mode to "NORMAL" (only mode we can RX & TX in)
 	if (okay && can_.setMode(MCP_NORMAL) != CAN_OK)
 	{
@@ -148,6 +230,9 @@ Device::init()
 		INFO("%d Rx CAN_Msg buffer (%dbytes)",
 				queue_.capacity(),
 				queue_.capacity() * sizeof(CAN_Msg));
+		INFO("%d Tx CAN_Msg buffer (%dbytes)",
+				txQueue_.capacity(),
+				txQueue_.capacity() * sizeof(CAN_Msg));
 	}
 	else
 	{
@@ -158,63 +243,224 @@ Device::init()
 void
 Device::interrupt()
 {
-	CAN_Msg *msg = queue_.getBackPtr();
+#if MEGA_CAN_TELEMETRY
+	// timer0 runs freely for millis(), so it's a free way to time the ISR
+	const uint8_t isrStartTicks = TCNT0;
+	const bool isrStartOvf = TIFR0 & _BV(TOV0);
+#endif
+#if MEGA_CAN_RX_TIMESTAMPS
+	// handlers called from the ISR see this interrupt's timestamp
+	const uint32_t mainRxStamp = rxStamp_;
+	rxStamp_ = MEGA_CAN_TIMESTAMP();
+#endif
 
-	while (can_.readMsgBuf(&msg->id,&msg->ext,&msg->len,msg->rxBuf) == CAN_OK)
+	// CANINTF holds every interrupt cause, so a single read tells us which
+	// receive buffers are full, which transmits completed, and whether the
+	// error registers need to be looked at at all
+	uint8_t intf = can_.readIntFlags();
+	while (intf & (MCP_RX_INT | MCP_TX_INT | MCP_ERR_INT))
 	{
-		// see if we should handle the broadcast messages immediately
-		if (opts_.handleStandardMsgsImmediately && msg->ext == 0)
+		// clear transmit and error flags before servicing them so that
+		// anything raised in the meantime interrupts us again
+		const uint8_t clearFlags = intf & (MCP_TX_INT | MCP_ERR_INT);
+		if (clearFlags)
 		{
-			handleStandard(msg->id,msg->len,msg->rxBuf);
+			can_.clearIntFlags(clearFlags);
 		}
-		else
+
+		// RXB0 fills first, so it holds the older frame when both are full
+		for (uint8_t rxbf=0; rxbf<2; rxbf++)
 		{
-			if (queue_.isFull())
+			if ((intf & (MCP_RX0IF << rxbf)) == 0)
 			{
-				canStatus_ |= CAN_STATUS_RX_OVERFLOW;
-				INC_ERROR_COUNTER(canSW_RxOverflowCount_);
+				continue;
 			}
-			else
+
+			// when the queue is full its back slot aliases the front slot that
+			// the main loop may be reading from, so read into a scratch frame
+			CAN_Msg *msg = (queue_.isFull() ? &overflowMsg_ : queue_.getBackPtr());
+			can_.readRxBuf(rxbf,&msg->id,&msg->ext,&msg->len,msg->rxBuf);
+#if MEGA_CAN_RX_TIMESTAMPS
+			msg->stamp = rxStamp_;
+#endif
+			TELEMETRY(onRxFrame());
+			receive(msg);
+		}
+
+		const uint8_t txDone = (intf >> 2) & txBusyMask_;
+		if (txDone)
+		{
+			txBusyMask_ &= ~txDone;
+			for (uint8_t b=txDone; b; b>>=1)
 			{
-				queue_.push();
-				msg = queue_.getBackPtr();
+				canTxCompleteCount_ += b & 0x1;
 			}
+			serviceTxQueue();
+		}
+
+		if (intf & MCP_ERRIF)
+		{
+			can_.serviceErrors((void*)this,&megaCAN_ErrHandlers);
 		}
+		if (intf & MCP_MERRF)
+		{
+			INC_ERROR_COUNTER(canHW_MsgErrorCount_);
+		}
+
+		// the INT pin stays asserted while any flag is pending, so only
+		// read the flags again (another SPI transaction) if it is
+		intf = (digitalRead(intPin_) == LOW ? can_.readIntFlags() : 0);
 	}
 
-	can_.serviceErrors((void*)this,&megaCAN_ErrHandlers);
+#if MEGA_CAN_RX_TIMESTAMPS
+	rxStamp_ = mainRxStamp;
+#endif
+	TELEMETRY(onIsr(isrTicksSince(isrStartTicks,isrStartOvf)));
 }
 
 void
 Device::handle()
 {
-	const CAN_Msg *msg = nullptr;
-	while (!queue_.isEmpty())
+	drainQueue();
+
+	// standard frames are handled one at a time, serving any protocol
+	// frames that arrived in the meantime first. this bounds a request's
+	// latency regardless of how much broadcast traffic is queued.
+	for (uint8_t nStd=stdQueue_.size(); nStd>0; nStd--)
 	{
-		msg = queue_.getFrontPtr();
-#if LOG_CAN_TRAFFIC
-		INFO("BUS >>> MCU %s", fmtCAN_DebugStr(msg->id,msg->ext,msg->len,msg->rxBuf));
-#endif
+		dispatch(stdQueue_.getFrontPtr());
+		stdQueue_.pop();
+		drainQueue();
+	}
 
-		if (msg->ext)
+	// latest frame from each standard identifier that changed since last time
+	const uint8_t nBoxes = mailboxes_.numUsed();
+	for (uint8_t b=0; b<nBoxes; b++)
+	{
+		CAN_Msg msg;
+		if (mailboxes_.take(b,msg))
 		{
-			const MS_HDR_t* hdr = reinterpret_cast<const MS_HDR_t*>(&msg->id);
+			dispatch(&msg);
+			drainQueue();
+		}
+	}
 
-			if(hdr->toId == myID_)
-			{
-				handleExtended(hdr,msg->len,msg->rxBuf);
-			}
-			else
-			{
-				WARN("msg not meant for me!!!");
-			}
+	serviceErrorState();
+	serviceTxTimeouts();
+
+#if MEGA_CAN_TELEMETRY
+	const uint32_t nowMs = millis();
+	if (telemetry_.rateWindowDone(nowMs))
+	{
+		telemetry_.updateRates(nowMs);
+	}
+#endif
+
+	handleDeferred();
+
+	// acknowledge background burns once they've completed
+	flushBurnAcks();
+}
+
+void
+Device::receive(
+		CAN_Msg *msg)
+{
+	// see if we should handle the broadcast messages immediately
+	if (opts_.handleStandardMsgsImmediately && msg->ext == 0)
+	{
+		handleStandard(msg->id,msg->len,msg->rxBuf);
+	}
+	else if (msg->ext == 0 && mailboxes_.capacity() > 0)
+	{
+		// standard frames never take up space in the RX queue
+		if ( ! mailboxes_.post(msg))
+		{
+			INC_ERROR_COUNTER(canSW_MailboxOverflowCount_);
+			TELEMETRY(onEvent(CAN_TELEM_SW_MAILBOX_OVERFLOW));
+		}
+	}
+	else if (msg->ext == 0 && stdQueue_.capacity() > 0)
+	{
+		// frame was read into the main queue's slot (which isn't pushed)
+		if (stdQueue_.isFull())
+		{
+			canStatus_ |= CAN_STATUS_RX_OVERFLOW;
+			INC_ERROR_COUNTER(canSW_StdRxOverflowCount_);
+			TELEMETRY(onEvent(CAN_TELEM_SW_STD_RX_OVERFLOW));
 		}
 		else
 		{
-			handleStandard(msg->id,msg->len,msg->rxBuf);
+			memcpy(stdQueue_.getBackPtr(),msg,sizeof(CAN_Msg));
+			stdQueue_.push();
+			TELEMETRY(onQueueDepth(CAN_TELEM_STD_QUEUE,stdQueue_.size()));
 		}
+	}
+	else if (msg == &overflowMsg_)
+	{
+		canStatus_ |= CAN_STATUS_RX_OVERFLOW;
+		INC_ERROR_COUNTER(canSW_RxOverflowCount_);
+		TELEMETRY(onEvent(CAN_TELEM_SW_RX_OVERFLOW));
+	}
+	else
+	{
+#if MEGA_CAN_TELEMETRY
+		// start the MSG_REQ to MSG_RSP latency clock
+		const MS_HDR_t *hdr = reinterpret_cast<const MS_HDR_t*>(&msg->id);
+		if (msg->ext && hdr->type == MSG_REQ && hdr->toId == myID_)
+		{
+			telemetry_.onReqReceived(micros());
+		}
+#endif
+		queue_.push();
+		TELEMETRY(onQueueDepth(CAN_TELEM_RX_QUEUE,queue_.size()));
+	}
+}
 
-		queue_.pop();
+void
+Device::drainQueue()
+{
+	// process frames in runs so the ISR only sees one front_ publish per run
+	uint8_t nMsgs = queue_.size();
+	while (nMsgs > 0)
+	{
+		for (uint8_t i=0; i<nMsgs; i++)
+		{
+			dispatch(queue_.peek(i));
+		}
+
+		queue_.pop(nMsgs);
+		nMsgs = queue_.size();
+	}
+}
+
+void
+Device::dispatch(
+		const CAN_Msg *msg)
+{
+#if LOG_CAN_TRAFFIC
+	INFO("BUS >>> MCU %s", fmtCAN_DebugStr(msg->id,msg->ext,msg->len,msg->rxBuf));
+#endif
+#if MEGA_CAN_RX_TIMESTAMPS
+	rxStamp_ = msg->stamp;
+#endif
+
+	if (msg->ext)
+	{
+		const MS_HDR_t* hdr = reinterpret_cast<const MS_HDR_t*>(&msg->id);
+
+		if(hdr->toId == myID_)
+		{
+			handleExtended(hdr,msg->len,msg->rxBuf);
+		}
+		else
+		{
+			WARN("msg not meant for me!!!");
+		}
+	}
+	else
+	{
+		handleStandard(msg->id,msg->len,msg->rxBuf);
 	}
 }
 
@@ -259,6 +505,24 @@ Device::applyCanFilters(
 	can->init_Filt(5,1,filt);
 }
 
+bool
+Device::applyFilterPlan(
+	const FilterPlan_t &plan)
+{
+	// keep CAN ISR from starting SPI transactions in the middle of ours.
+	// the mode changes time out on millis(), so other interrupts stay on
+	const uint8_t intMask = maskCanInterrupt();
+	const uint8_t res = plan.write(&can_);
+	unmaskCanInterrupt(intMask);
+
+	if (res != MCP2515_OK)
+	{
+		ERROR("failed to apply CAN filter plan");
+		return false;
+	}
+	return true;
+}
+
 bool
 Device::readFromTable(
 		const uint8_t table,
@@ -290,6 +554,28 @@ Device::burnTable(
 	return false;
 }
 
+bool
+Device::burnInProgress()
+{
+	// base class burns synchronously
+	return false;
+}
+
+void
+Device::handleDeferred()
+{
+	// base class has nothing to defer
+}
+
+bool
+Device::tableCRC(
+		const uint8_t table,
+		uint32_t &crc)
+{
+	WARN("subclass should override tableCRC()");
+	return false;
+}
+
 // provide default implementation, but subclass should override
 uint16_t
 Device::tableBlockingFactor()
@@ -337,6 +623,60 @@ Device::simReqDrop(
 // Private Methods
 //--------------------------------------------------------------------
 
+void
+Device::queueBurnAck(
+		const uint8_t toId,
+		const uint8_t fromId)
+{
+	if (numBurnAcks_ >= MEGA_CAN_MAX_PENDING_BURN_ACKS)
+	{
+		// handleExtended() refuses burns before it gets to this point
+		INC_ERROR_COUNTER(canLogicErrorCount_);
+		return;
+	}
+
+	burnAcks_[numBurnAcks_].toId = toId;
+	burnAcks_[numBurnAcks_].fromId = fromId;
+	numBurnAcks_++;
+}
+
+void
+Device::flushBurnAcks()
+{
+	if (numBurnAcks_ == 0 || burnInProgress())
+	{
+		return;
+	}
+
+	for (uint8_t a=0; a<numBurnAcks_; a++)
+	{
+		sendBurnAck(burnAcks_[a].toId,burnAcks_[a].fromId,true);
+	}
+	numBurnAcks_ = 0;
+}
+
+void
+Device::sendBurnAck(
+		const uint8_t toId,
+		const uint8_t fromId,
+		const bool burnOkay)
+{
+	// submit burn acknowledge
+	rspHdr_.toId = toId;
+	rspHdr_.fromId = fromId;
+	rspHdr_.type = MSG_XTND;
+	setTable(&rspHdr_,0);// don't care
+	rspHdr_.offset = 0;// don't care
+	txBuf_[0] = MSG_BURNACK;
+	txBuf_[1] = (burnOkay ? 1 : 0);
+
+	if ( ! sendMsgBuf(rspHdr_.marshal(),true,2,txBuf_))
+	{
+		INC_ERROR_COUNTER(canLogicErrorCount_);
+		canStatus_ |= CAN_STATUS_TX_FAILED;
+	}
+}
+
 void
 Device::setupOptions()
 {
@@ -364,11 +704,18 @@ Device::handleExtended(
 	switch(hdr->type)
 	{
 	case MSG_CMD:
+		if (table == TABLE_NO_TELEMETRY)
+		{
+			WARN("telemetry table is read-only");
+			break;
+		}
 		// TODO do something with return value
 		writeToTable(table,hdr->offset,length,data);
 		break;
 	case MSG_REQ:
-		if (numSimReqDropsLeft_ == 0)
+	{
+		const bool respond = (numSimReqDropsLeft_ == 0);
+		if (respond)
 		{
 			handleRequest(hdr,data);
 		}
@@ -376,24 +723,36 @@ Device::handleExtended(
 		{
 			numSimReqDropsLeft_--;
 		}
+#if MEGA_CAN_TELEMETRY
+		MC_ATOMIC_START
+		telemetry_.onReqHandled(micros(),respond);
+		MC_ATOMIC_END
+#endif
 		break;
+	}
 	case MSG_BURN:
 	{
-		bool burnOkay = burnTable(table);
-
-		// submit burn acknowledge
-		rspHdr_.toId = hdr->fromId;
-		rspHdr_.fromId = hdr->toId;
-		rspHdr_.type = MSG_XTND;
-		setTable(&rspHdr_,0);// don't care
-		rspHdr_.offset = 0;// don't care
-		txBuf_[0] = MSG_BURNACK;
-		txBuf_[1] = (burnOkay ? 1 : 0);
+		// burnTable() can return while an earlier burn is still running
+		// (ie. nothing to burn, or new edits folded into the running burn),
+		// so earlier acks are only sent once no burn is in progress
+		flushBurnAcks();
+		if (numBurnAcks_ >= MEGA_CAN_MAX_PENDING_BURN_ACKS)
+		{
+			// refuse rather than wait for the background burns to complete
+			WARN("too many burns pending. refusing burn of table %d", table);
+			sendBurnAck(hdr->fromId,hdr->toId,false);
+			break;
+		}
 
-		if ( ! sendMsgBuf(rspHdr_.marshal(),true,2,txBuf_))
+		bool burnOkay = burnTable(table);
+		if (burnOkay && (burnInProgress() || numBurnAcks_ > 0))
 		{
-			INC_ERROR_COUNTER(canLogicErrorCount_);
-			canStatus_ |= CAN_STATUS_TX_FAILED;
+			// acknowledge once the background burn completes (see handle())
+			queueBurnAck(hdr->fromId,hdr->toId);
+		}
+		else
+		{
+			sendBurnAck(hdr->fromId,hdr->toId,burnOkay);
 		}
 		break;
 	}
@@ -415,6 +774,7 @@ Device::handleRequest(
 	MSG_REQ_t* req = reinterpret_cast<MSG_REQ_t*>(reqData);
 	uint8_t reqTable = getTable(hdr);
 	uint16_t rspOffset = getOffset(req);
+	uint8_t rspLength = req->rspLength;
 
 	DEBUG(
 			"handleRequest - "
@@ -422,11 +782,27 @@ Device::handleRequest(
 			reqTable,
 			hdr->offset,
 			req->rspTable,
-			req->rspLength,
+			rspLength,
 			rspOffset);
 
+	// requests beyond a single frame are streamed back as multiple MSG_RSP
+	// frames, but are limited to what we advertised via MSG_PROT
+	if (rspLength > 8 && rspLength > tableBlockingFactor())
+	{
+		ERROR("Requested %d bytes; more than blocking factor!", rspLength);
+		okay = false;
+	}
+
+#if MEGA_CAN_TELEMETRY
+	CAN_TelemetryTable_t telemetry;
+#endif
+
 	const uint8_t *resData = NULL;
-	if (reqTable == TABLE_NO_SIG)
+	if ( ! okay)
+	{
+		// response will be zero filled
+	}
+	else if (reqTable == TABLE_NO_SIG)
 	{
 		// Send the firmware signature
 
@@ -437,14 +813,14 @@ Device::handleRequest(
 					__MegaCAN_SerialSignature);
 		}
 
-		if ((hdr->offset + req->rspLength) > MAX_SIGNATURE_BYTES)
+		if ((hdr->offset + rspLength) > MAX_SIGNATURE_BYTES)
 		{
 			ERROR("Requested too many bytes from signature!");
 			okay = false;
 		}
 		else
 		{
-			resData = __MegaCAN_SerialSignature + hdr->offset;
+			resData = (const uint8_t *)(__MegaCAN_SerialSignature) + hdr->offset;
 		}
 	}
 	else if (reqTable == TABLE_NO_REV)
@@ -458,31 +834,34 @@ Device::handleRequest(
 					__MegaCAN_SerialRevision);
 		}
 
-		// send the firmware revision. pad with trailing zeros.
-		uint16_t offset = hdr->offset;
-		for (uint8_t i=0; i<req->rspLength; i++, offset++)
+		// revision is padded with trailing zeros as each frame is built
+		resData = txBuf_;
+	}
+#if MEGA_CAN_TELEMETRY
+	else if (reqTable == TABLE_NO_TELEMETRY)
+	{
+		if ((size_t)(hdr->offset + rspLength) > sizeof(telemetry))
 		{
-			if (offset < __MegaCAN_SerialRevisionLen)
-			{
-				txBuf_[i] = __MegaCAN_SerialRevision[offset];
-			}
-			else
-			{
-				txBuf_[i] = '\0';
-			}
+			ERROR("Requested too many bytes from telemetry!");
+			okay = false;
+		}
+		else
+		{
+			readTelemetry(telemetry);
+			resData = (const uint8_t *)(&telemetry) + hdr->offset;
 		}
-		resData = txBuf_;
 	}
+#endif
 	else
 	{
 		okay = okay && readFromTable(
 				reqTable,
 				hdr->offset,
-				req->rspLength,
+				rspLength,
 				resData);
 	}
 
-	if (resData == NULL)
+	if (okay && resData == NULL)
 	{
 		ERROR("handleRequest - resData is NULL");
 		okay = false;
@@ -492,32 +871,60 @@ Device::handleRequest(
 	rspHdr_.fromId = hdr->toId;
 	rspHdr_.type = MSG_RSP;
 	setTable(&rspHdr_,req->rspTable);
-	rspHdr_.offset = rspOffset;
 
-	if (okay)
+	// send back consecutive MSG_RSP frames with incrementing offsets. the
+	// frames get pipelined through the MCP2515's transmit buffers.
+	uint8_t sent = 0;
+	do
 	{
+		uint8_t chunkLen = rspLength - sent;
+		if (chunkLen > 8)
+		{
+			chunkLen = 8;
+		}
+
+		const uint8_t *chunkData = txBuf_;
+		if ( ! okay)
+		{
+			// handle response, but send back zeros
+			memset(txBuf_,0,chunkLen);
+		}
+		else if (reqTable == TABLE_NO_REV)
+		{
+			// send the firmware revision. pad with trailing zeros.
+			uint16_t offset = hdr->offset + sent;
+			for (uint8_t i=0; i<chunkLen; i++, offset++)
+			{
+				if (offset < __MegaCAN_SerialRevisionLen)
+				{
+					txBuf_[i] = __MegaCAN_SerialRevision[offset];
+				}
+				else
+				{
+					txBuf_[i] = '\0';
+				}
+			}
+		}
+		else
+		{
+			chunkData = resData + sent;
+		}
+
+		rspHdr_.offset = rspOffset + sent;
+
 		// send MSG_RSP packet
 		if ( ! sendMsgBuf(
 				rspHdr_.marshal(),
 				true,
-				req->rspLength,
-				const_cast<uint8_t*>(resData)))
-		{
-			INC_ERROR_COUNTER(canLogicErrorCount_);
-			canStatus_ |= CAN_STATUS_TX_FAILED;
-		}
-	}
-	else
-	{
-		// handle response, but send back zeros
-		memset(txBuf_,0,req->rspLength);
-
-		if ( ! sendMsgBuf(rspHdr_.marshal(),true,req->rspLength,txBuf_))
+				chunkLen,
+				const_cast<uint8_t*>(chunkData)))
 		{
 			INC_ERROR_COUNTER(canLogicErrorCount_);
 			canStatus_ |= CAN_STATUS_TX_FAILED;
+			break;
 		}
-	}
+		sent += chunkLen;
+	} while (sent < rspLength);
 }
 
 void
@@ -589,12 +996,286 @@ Device::handleExtendedMsg(
 		break;
 	}// END -- MSG_PROT handling
 
+	case MSG_CRC:
+	{
+		if (length == 4)
+		{
+			const uint8_t table = getTable(hdr);
+			uint32_t crc = 0;
+			if ( ! tableCRC(table,crc))
+			{
+				ERROR("MSG_CRC failed on table %d", table);
+				crc = 0;// respond with zero so requester doesn't hang
+			}
+
+			// populate response header
+			rspHdr_.toId = hdr->fromId;
+			rspHdr_.fromId = hdr->toId;
+			rspHdr_.type = MSG_RSP;
+			setTable(&rspHdr_,GET_MSG_CRC_MYVARBLK(data));
+			rspHdr_.offset = GET_MSG_CRC_MYVAROFFSET(data);
+
+			DEBUG(
+				"MSG_CRC: table = %d, crc = 0x%08lx, rspTable = %d, rspOffset = %d",
+				table,
+				crc,
+				getTable(&rspHdr_),
+				rspHdr_.offset);
+
+			// CRC is sent big endian
+			txBuf_[0] = (crc >> 24) & 0xff;
+			txBuf_[1] = (crc >> 16) & 0xff;
+			txBuf_[2] = (crc >> 8) & 0xff;
+			txBuf_[3] = crc & 0xff;
+
+			// send CRC response
+			if ( ! sendMsgBuf(rspHdr_.marshal(),true,4,txBuf_))
+			{
+				INC_ERROR_COUNTER(canLogicErrorCount_);
+				canStatus_ |= CAN_STATUS_TX_FAILED;
+			}
+		}
+		else
+		{
+			ERROR("Invalid MSG_CRC length %d", length);
+			return;
+		}
+		break;
+	}// END -- MSG_CRC handling
+
 	default:
 		ERROR("Unimplemented EXT_MSG type: %d", data[0]);
 		break;
 	}
 }
 
+void
+Device::serviceTxQueue()
+{
+	while ( ! txQueue_.isEmpty() && txBusyMask_ != 0x7)
+	{
+		/**
+		 * The MCP2515 sends equal priority buffers highest buffer number
+		 * first, so give each newly loaded frame a lower TXP than the ones
+		 * already in flight to keep frames in FIFO order on the wire. Once
+		 * the lowest priority is used, wait for the buffers to drain.
+		 */
+		uint8_t prio = 3;
+		if (txBusyMask_ != 0x0)
+		{
+			if (txPrio_ == 0)
+			{
+				break;
+			}
+			prio = txPrio_ - 1;
+		}
+
+		uint8_t txbuf = 0;
+		while (txBusyMask_ & (1 << txbuf))
+		{
+			txbuf++;
+		}
+
+		const CAN_Msg *msg = txQueue_.getFrontPtr();
+		can_.loadTxBuf(txbuf,prio,msg->id,msg->ext,msg->len,msg->rxBuf);
+		TELEMETRY(onTxFrame());
+		txBusyMask_ |= (1 << txbuf);
+		txLoadTime_[txbuf] = (uint16_t)(millis());
+		txPrio_ = prio;
+		txQueue_.pop();
+	}
+}
+
+void
+Device::serviceTxTimeouts()
+{
+	if (txBusyMask_ == 0x0)
+	{
+		return;
+	}
+
+	const uint16_t now = (uint16_t)(millis());
+	MC_ATOMIC_START
+	bool freed = false;
+	for (uint8_t txbuf=0; txbuf<3; txbuf++)
+	{
+		const uint8_t bit = 1 << txbuf;
+		if ((txBusyMask_ & bit) == 0 ||
+			(uint16_t)(now - txLoadTime_[txbuf]) < CAN_TX_TIMEOUT_MS)
+		{
+			continue;
+		}
+
+		const uint8_t ctrl = can_.readTxCtrl(txbuf);
+		if (ctrl & MCP_TXB_TXREQ_M)
+		{
+			// still trying to send. released on a later call once it stops
+			can_.abortTxBuf(txbuf);
+		}
+		else if (ctrl & MCP_TXB_ABTF_M)
+		{
+			txBusyMask_ &= ~bit;
+			canTxFailCount_++;
+			canStatus_ |= CAN_STATUS_TX_FAILED;
+			freed = true;
+		}
+		// otherwise it was sent just now; the ISR will see its TXnIF
+	}
+
+	if (freed)
+	{
+		serviceTxQueue();
+	}
+	MC_ATOMIC_END
+}
+
+// maps the MCP2515's error flags to a CAN_ERR_STATE_* value
+static uint8_t
+errorStateOf(
+	const uint8_t eflg)
+{
+	if (eflg & MCP_EFLG_TXBO)
+	{
+		return CAN_ERR_STATE_BUS_OFF;
+	}
+	else if (eflg & (MCP_EFLG_TXEP | MCP_EFLG_RXEP))
+	{
+		return CAN_ERR_STATE_PASSIVE;
+	}
+	else if (eflg & MCP_EFLG_EWARN)
+	{
+		return CAN_ERR_STATE_WARNING;
+	}
+	return CAN_ERR_STATE_ACTIVE;
+}
+
+void
+Device::raiseErrorState(
+	uint8_t state)
+{
+	if (state > errState_)
+	{
+		setErrorState(state);
+	}
+}
+
+void
+Device::setErrorState(
+	uint8_t state)
+{
+	if (state == errState_)
+	{
+		return;
+	}
+
+	errState_ = state;
+	errStateTime_ = millis();
+	INC_ERROR_COUNTER(errStateEntryCounts_[state]);
+}
+
+void
+Device::serviceErrorState()
+{
+	// nothing to poll while error active; ERRIF reports the counters rising
+	if (errState_ == CAN_ERR_STATE_ACTIVE)
+	{
+		return;
+	}
+
+	const uint32_t now = millis();
+	if ((now - errPollTime_) < CAN_ERR_STATE_POLL_MS)
+	{
+		return;
+	}
+	errPollTime_ = now;
+
+	uint8_t prevState;
+	uint32_t stateTime;
+	MC_ATOMIC_START
+	prevState = errState_;
+	setErrorState(errorStateOf(can_.getError()));
+	stateTime = errStateTime_;
+	MC_ATOMIC_END
+
+	if (errState_ == CAN_ERR_STATE_BUS_OFF)
+	{
+		// the MCP2515 leaves bus-off by itself after seeing 128 idle periods
+		// on the bus. if that's taking too long, restart it.
+		if ((now - stateTime) >= busOffBackoffMs_)
+		{
+			restartAfterBusOff();
+		}
+	}
+	else if (prevState == CAN_ERR_STATE_BUS_OFF)
+	{
+		INFO("recovered from bus-off");
+		busOffBackoffMs_ = CAN_BUS_OFF_MIN_BACKOFF_MS;
+		MC_ATOMIC_START
+		serviceTxQueue();
+		MC_ATOMIC_END
+	}
+}
+
+uint8_t
+Device::maskCanInterrupt()
+{
+	const uint8_t intNum = digitalPinToInterrupt(intPin_);
+	uint8_t mask = 0x0;
+	if (intNum < sizeof(EXT_INT_BITS))
+	{
+		mask = 1 << EXT_INT_BITS[intNum];
+	}
+
+	MC_ATOMIC_START
+	mask &= EIMSK;
+	EIMSK &= ~mask;
+	MC_ATOMIC_END
+	return mask;
+}
+
+void
+Device::unmaskCanInterrupt(
+	uint8_t mask)
+{
+	MC_ATOMIC_START
+	EIMSK |= mask;
+	MC_ATOMIC_END
+}
+
+void
+Device::restartAfterBusOff()
+{
+	WARN("still bus-off after %ums. restarting MCP2515", busOffBackoffMs_);
+
+	// only the CAN ISR is held off. the mode changes time out on millis()
+	const uint8_t intMask = maskCanInterrupt();
+	// frames that were loaded when the bus went off are dropped
+	can_.abortTX();
+	bool okay = can_.setMode(MODE_CONFIG) == CAN_OK;
+	can_.resumeTX();
+	if (can_.setMode(MCP_NORMAL) != CAN_OK)
+	{
+		okay = false;
+	}
+	MC_ATOMIC_START
+	can_.clearIntFlags(MCP_TX_INT);
+	txBusyMask_ = 0x0;
+	errStateTime_ = millis();
+	MC_ATOMIC_END
+	unmaskCanInterrupt(intMask);
+
+	if ( ! okay)
+	{
+		ERROR("MCP2515 restart failed!");
+	}
+
+	INC_ERROR_COUNTER(busOffRestartCount_);
+	if (busOffBackoffMs_ < CAN_BUS_OFF_MAX_BACKOFF_MS)
+	{
+		busOffBackoffMs_ *= 2;
+	}
+}
+
 bool
 Device::sendMsgBuf(
 	uint32_t id,
@@ -604,10 +1285,46 @@ Device::sendMsgBuf(
 {
 	uint8_t res = CAN_OK;
 
+	// don't keep feeding the MCP2515 while it can't transmit
+	if (errState_ == CAN_ERR_STATE_BUS_OFF)
+	{
+		return false;
+	}
+
 #if LOG_CAN_TRAFFIC
 		INFO("BUS <<< MCU %s", fmtCAN_DebugStr(id,ext,len,buf));
 #endif
 
+	if (txQueue_.capacity() > 0)
+	{
+		if (txQueue_.isFull())
+		{
+			INC_ERROR_COUNTER(canSW_TxOverflowCount_);
+			TELEMETRY(onEvent(CAN_TELEM_SW_TX_OVERFLOW));
+			return false;
+		}
+
+		CAN_Msg *msg = txQueue_.getBackPtr();
+		msg->id = id;
+		msg->ext = ext;
+		msg->len = (len > 8 ? 8 : len);
+		memcpy(msg->rxBuf,buf,msg->len);
+		txQueue_.push();
+
+		// kick off transmission if the MCP2515 has a free buffer. the ISR
+		// will continue feeding the rest as buffers complete.
+		MC_ATOMIC_START
+		TELEMETRY(onQueueDepth(CAN_TELEM_TX_QUEUE,txQueue_.size()));
+		serviceTxQueue();
+		if ( ! txQueue_.isEmpty())
+		{
+			TELEMETRY(onEvent(CAN_TELEM_TX_BUFFERS_FULL));
+		}
+		MC_ATOMIC_END
+
+		return true;
+	}
+
 	/**
 	 * Disable interrupts because we don't want to initiate any SPI
 	 * transactions from arriving CAN message while we're trying to send
@@ -616,6 +1333,14 @@ Device::sendMsgBuf(
 	 */
 	MC_ATOMIC_START
 	res = can_.sendMsgBuf(id,ext,len,buf,false);// false -> don't wait for send
+	if (res == CAN_OK)
+	{
+		TELEMETRY(onTxFrame());
+	}
+	else if (res == CAN_GETTXBFTIMEOUT)
+	{
+		TELEMETRY(onEvent(CAN_TELEM_TX_BUFFERS_FULL));
+	}
 	MC_ATOMIC_END
 
 	return res == CAN_OK;
@@ -10,11 +10,15 @@
 #include <stdint.h>
 
 #include "logging.h"
+#include "MegaCAN_FilterPlanner.h"
+#include "MegaCAN_Telemetry.h"
 #include "MSG_defn.h"
 
 #include <util/atomic.h>
 #define MC_ATOMIC_START ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
 #define MC_ATOMIC_END }
+// prevents the compiler from reordering memory accesses across this point
+#define MC_COMPILER_BARRIER() __asm__ __volatile__("" ::: "memory")
 
 #define DECL_MEGA_CAN_REV(USER_REV) \
 	static_assert(sizeof(USER_REV) <= MAX_REVISION_BYTES, \
@@ -30,6 +34,40 @@
 #define CAN_STATUS_RX_OVERFLOW 0x1
 #define CAN_STATUS_TX_FAILED   0x2
 
+// CAN fault confinement states (see Device::getErrorState())
+#define CAN_ERR_STATE_ACTIVE  0// TEC and REC are below 96
+#define CAN_ERR_STATE_WARNING 1// TEC or REC reached 96
+#define CAN_ERR_STATE_PASSIVE 2// TEC or REC reached 128
+#define CAN_ERR_STATE_BUS_OFF 3// TEC went past 255
+#define CAN_NUM_ERR_STATES    4
+
+// how often the error counters are polled while not error active (ms)
+#define CAN_ERR_STATE_POLL_MS 100
+
+// how long to wait for the MCP2515 to recover from bus-off on its own before
+// restarting it. the wait doubles after each restart that doesn't help.
+#define CAN_BUS_OFF_MIN_BACKOFF_MS 200
+#define CAN_BUS_OFF_MAX_BACKOFF_MS 3200
+
+// how long a loaded transmit buffer may go unsent (ie. never ACKed) before
+// it's aborted and counted as a failed frame (ms)
+#define CAN_TX_TIMEOUT_MS 100
+
+// number of MSG_BURNACKs that can wait on a background burn (further burn
+// requests are refused until one has been sent)
+#define MEGA_CAN_MAX_PENDING_BURN_ACKS 4
+
+// only every Nth optional frame (ie. realtime broadcasts) is sent while
+// error passive
+#define CAN_ERR_PASSIVE_TX_DIVISOR 4
+
+#define MEGA_CAN_RX_TIMESTAMPS 0// set to 1 to timestamp received frames (adds 4bytes per frame)
+
+// receive timestamp (us, in 4us steps with a 16MHz clock). read once per
+// interrupt; micros() is timer0's overflow count plus TCNT0, and it accounts
+// for an overflow that's pending while the CAN ISR runs
+#define MEGA_CAN_TIMESTAMP() ((uint32_t)(micros()))
+
 namespace MegaCAN
 {
 
@@ -43,8 +81,25 @@ struct CAN_Msg
 	uint8_t  len;
 	// the payload attachment
 	uint8_t  rxBuf[8];
+#if MEGA_CAN_RX_TIMESTAMPS
+	// MEGA_CAN_TIMESTAMP() of the interrupt that read the frame
+	uint32_t stamp;
+#endif
 };
 
+/**
+ * Single-producer/single-consumer ring buffer of CAN frames.
+ * 
+ * The CAN ISR is the only producer (getBackPtr()/push() modify back_) and
+ * the main loop is the only consumer (getFrontPtr()/peek()/pop() modify
+ * front_). Both indices are free running 8bit counters that are masked
+ * into the buffer, so each side only ever writes its own index and reads
+ * the other side's with a single (atomic) byte load. No global interrupt
+ * disable is needed.
+ * 
+ * The usable capacity is the largest power of two that fits within the
+ * provided buffer (max of 128 frames).
+ */
 class CAN_MsgQueue
 {
 public:
@@ -52,119 +107,316 @@ public:
 		CAN_Msg *buff,
 		uint8_t size)
 	{
-		buff_ = buff;
-		buff_size_ = size;
-		clear();
+		setup(buff,size);
 	}
 
 	~CAN_MsgQueue()
 	{
 	}
 
+	/**
+	 * (Re)assigns the queue's storage and empties it. Not safe to call
+	 * while the producer is active (ie. before interrupts are enabled).
+	 */
+	void
+	setup(
+		CAN_Msg *buff,
+		uint8_t size)
+	{
+		buff_ = buff;
+		capacity_ = 0;
+		if (buff != nullptr && size > 0)
+		{
+			capacity_ = 1;
+			while (capacity_ < 128 && (uint8_t)(capacity_ << 1) <= size)
+			{
+				capacity_ <<= 1;
+			}
+		}
+		mask_ = capacity_ - 1;
+		clear();
+	}
+
+	/**
+	 * Resets the queue to empty. Not safe to call while the producer is
+	 * active (ie. before interrupts are enabled).
+	 */
 	void
 	clear()
 	{
 		front_ = 0;
 		back_ = 0;
-		size_ = 0;
 	}
 
 	bool
 	isFull() const
 	{
-		MC_ATOMIC_START
-		return next(back_) == front_;
-		MC_ATOMIC_END
+		return size() >= capacity_;
 	}
 
 	bool
 	isEmpty() const
 	{
-		MC_ATOMIC_START
-		return size_ == 0;
-		MC_ATOMIC_END
+		return front_ == back_;
 	}
 
+	/**
+	 * Producer side. Publishes the frame at getBackPtr() to the consumer.
+	 */
 	void
 	push()
 	{
-		MC_ATOMIC_START
-		if (next(back_) != front_)// make sure it's not full
+		if ( ! isFull())
 		{
-			back_ = next(back_);
-			size_++;
+			// make sure frame contents are stored before publishing index
+			MC_COMPILER_BARRIER();
+			back_ = back_ + 1;
 		}
-		MC_ATOMIC_END
 	}
 
+	/**
+	 * Consumer side. Releases the frame at the front of the queue.
+	 */
 	void
 	pop()
 	{
-		MC_ATOMIC_START
-		if (size_ != 0)// make sure it's not empty
-		{
-			front_ = next(front_);
-			size_--;
-		}
-		MC_ATOMIC_END
+		pop(1);
 	}
 
-	unsigned int
-	size()
+	/**
+	 * Consumer side. Releases the first n frames of the queue back to the
+	 * producer with a single index publish.
+	 * 
+	 * @param[in] n
+	 * Number of frames to release. Clamped to the current size().
+	 */
+	void
+	pop(
+		uint8_t n)
 	{
-		MC_ATOMIC_START
-		if (back_ >= front_)
+		const uint8_t currSize = size();
+		if (n > currSize)
 		{
-			return back_ - front_;
+			n = currSize;
 		}
-		else
-		{
-			return back_ + buff_size_ - front_;
-		}
-		MC_ATOMIC_END
+		// make sure we're done reading frames before handing them back
+		MC_COMPILER_BARRIER();
+		front_ = front_ + n;
+	}
+
+	/**
+	 * @return
+	 * Number of frames currently stored in the queue. When called from the
+	 * consumer, the result is a lower bound (producer may push more).
+	 */
+	uint8_t
+	size() const
+	{
+		return (uint8_t)(back_ - front_);
 	}
 
 	uint8_t
 	capacity() const
 	{
-		return buff_size_;
+		return capacity_;
 	}
 
 	CAN_Msg *
 	getFrontPtr()
 	{
-		return &buff_[front_];
+		return &buff_[front_ & mask_];
+	}
+
+	/**
+	 * Consumer side. Access the n-th frame from the front of the queue
+	 * without releasing it. Caller must ensure n < size().
+	 */
+	CAN_Msg *
+	peek(
+		uint8_t n)
+	{
+		return &buff_[(uint8_t)(front_ + n) & mask_];
 	}
 
 	CAN_Msg *
 	getBackPtr()
 	{
-		return &buff_[back_];
+		return &buff_[back_ & mask_];
 	}
 
 private:
+	// block of CAN messages to use for the queue
+	CAN_Msg *buff_;
+	// the number of usable elements in buff_ (power of 2)
+	uint8_t capacity_;
+	// capacity_ - 1; used to wrap the free running indices
+	uint8_t mask_;
+
+	// only written by the consumer
+	volatile uint8_t front_;
+	// only written by the producer
+	volatile uint8_t back_;
+
+};
+
+// max number of mailboxes a CAN_MailboxStore can manage
+#define MEGA_CAN_MAX_MAILBOXES 32
+
+struct CAN_Mailbox
+{
+	// 11bit identifier this mailbox holds frames for
+	uint32_t id;
+	// the length of data in the rxBuf
+	uint8_t  len;
+	// payload of the most recent frame with this identifier
+	uint8_t  rxBuf[8];
+#if MEGA_CAN_RX_TIMESTAMPS
+	// receive timestamp of the most recent frame
+	uint32_t stamp;
+#endif
+};
+
+/**
+ * Per-identifier storage for standard (11bit) frames.
+ * 
+ * A mailbox is claimed for an identifier the first time a frame with that
+ * identifier arrives. Newer frames overwrite the pending one in place, so
+ * a flood of broadcast frames only ever holds the latest copy of each and
+ * memory use is bounded by the number of mailboxes.
+ * 
+ * The CAN ISR is the only producer (post()) and the main loop is the only
+ * consumer (take()).
+ */
+class CAN_MailboxStore
+{
+public:
+	CAN_MailboxStore()
+	{
+		setup(nullptr,0);
+	}
+
+	/**
+	 * Not safe to call while the producer is active (ie. before interrupts
+	 * are enabled).
+	 * 
+	 * @param[in] boxes
+	 * Block of mailboxes to use (or nullptr to disable the store)
+	 * 
+	 * @param[in] numBoxes
+	 * Number of mailboxes in boxes (max of MEGA_CAN_MAX_MAILBOXES)
+	 */
+	void
+	setup(
+		CAN_Mailbox *boxes,
+		uint8_t numBoxes)
+	{
+		boxes_ = boxes;
+		capacity_ = (boxes ? min(numBoxes,(uint8_t)(MEGA_CAN_MAX_MAILBOXES)) : 0);
+		numUsed_ = 0;
+		memset((void*)(pending_),0,sizeof(pending_));
+	}
+
 	uint8_t
-	next(
-			uint8_t idx) const
+	capacity() const
 	{
-		// idx is a local copy, so it's safe to increment
-		idx++;
-		if (idx >= buff_size_)
+		return capacity_;
+	}
+
+	/**
+	 * @return
+	 * Number of mailboxes that have been claimed by an identifier
+	 */
+	uint8_t
+	numUsed() const
+	{
+		return numUsed_;
+	}
+
+	/**
+	 * Producer side. Stores a frame in its identifier's mailbox and flags
+	 * the mailbox as pending.
+	 * 
+	 * @return
+	 * False if the identifier doesn't have a mailbox and none are free
+	 */
+	bool
+	post(
+		const CAN_Msg *msg)
+	{
+		uint8_t b = 0;
+		while (b < numUsed_ && boxes_[b].id != msg->id)
+		{
+			b++;
+		}
+
+		if (b == numUsed_)
 		{
-			idx = 0;
+			if (numUsed_ >= capacity_)
+			{
+				return false;
+			}
+			boxes_[b].id = msg->id;
+			numUsed_ = numUsed_ + 1;
 		}
-		return idx;
+
+		CAN_Mailbox &box = boxes_[b];
+		box.len = (msg->len > 8 ? 8 : msg->len);
+		memcpy(box.rxBuf,msg->rxBuf,box.len);
+#if MEGA_CAN_RX_TIMESTAMPS
+		box.stamp = msg->stamp;
+#endif
+		pending_[b >> 3] |= (1 << (b & 0x7));
+		return true;
+	}
+
+	/**
+	 * Consumer side. Copies out a mailbox's frame if it's pending and
+	 * clears its pending flag.
+	 * 
+	 * @param[in] b
+	 * Index of the mailbox (less than numUsed())
+	 * 
+	 * @param[out] msg
+	 * The mailbox's most recent frame
+	 * 
+	 * @return
+	 * True if the mailbox was pending, false otherwise
+	 */
+	bool
+	take(
+		const uint8_t b,
+		CAN_Msg &msg)
+	{
+		const uint8_t bit = (1 << (b & 0x7));
+		if ((pending_[b >> 3] & bit) == 0)
+		{
+			return false;
+		}
+
+		// ISR may overwrite the mailbox while we're copying it
+		MC_ATOMIC_START
+		const CAN_Mailbox &box = boxes_[b];
+		msg.id = box.id;
+		msg.ext = 0;
+		msg.len = box.len;
+		memcpy(msg.rxBuf,box.rxBuf,box.len);
+#if MEGA_CAN_RX_TIMESTAMPS
+		msg.stamp = box.stamp;
+#endif
+		pending_[b >> 3] &= ~bit;
+		MC_ATOMIC_END
+		return true;
 	}
 
 private:
-	// block of CAN messages to use for the queue
-	CAN_Msg *buff_;
-	// the number of allocated elements in buff_
-	uint8_t buff_size_;
+	CAN_Mailbox *boxes_;
+	uint8_t capacity_;
 
-	volatile uint8_t front_;
-	volatile uint8_t back_;
-	volatile uint8_t size_;
+	// only written by the producer (after the claimed mailbox's id is set)
+	volatile uint8_t numUsed_;
+
+	// bit n set when mailbox n holds a frame handle() hasn't seen yet
+	volatile uint8_t pending_[MEGA_CAN_MAX_MAILBOXES / 8];
 
 };
 
@@ -183,18 +435,78 @@ class Device
 {
 
 public:
+	/**
+	 * @param[in] buff
+	 * Buffer of frames used to queue received messages until handle()
+	 * 
+	 * @param[in] buffSize
+	 * Number of frames in buff (queue capacity is rounded down to a power of 2)
+	 * 
+	 * @param[in] txBuff
+	 * Optional buffer of frames used to queue outgoing messages. When
+	 * provided, frames are fed to the MCP2515's transmit buffers from the
+	 * TX complete interrupts and sending never blocks the main loop. When
+	 * omitted, frames are written to the MCP2515 synchronously.
+	 * 
+	 * @param[in] txBuffSize
+	 * Number of frames in txBuff (capacity is rounded down to a power of 2)
+	 */
 	Device(
 			uint8_t cs,
 			uint8_t myId,
 			uint8_t intPin,
 			CAN_Msg *buff,
-			uint8_t buffSize);
+			uint8_t buffSize,
+			CAN_Msg *txBuff = nullptr,
+			uint8_t txBuffSize = 0);
 
 	Device() = delete;
 
 	virtual
 	~Device();
 
+	/**
+	 * Gives standard (11bit) frames their own RX queue so that broadcast
+	 * traffic can't delay or crowd out extended (29bit) protocol frames.
+	 * Extended frames are always handled first. Must be called before
+	 * init(). Without it, both kinds of frames share the main RX queue.
+	 * 
+	 * @param[in] buff
+	 * Buffer of frames used to queue standard frames until handle()
+	 * 
+	 * @param[in] buffSize
+	 * Number of frames in buff (queue capacity is rounded down to a power of 2)
+	 */
+	void
+	setStdQueue(
+		CAN_Msg *buff,
+		uint8_t buffSize)
+	{
+		stdQueue_.setup(buff,buffSize);
+	}
+
+	/**
+	 * Stores standard (11bit) frames in per-identifier mailboxes rather than
+	 * the RX queue. A newer frame with the same identifier replaces the
+	 * pending one, so broadcast floods can't crowd requests out of the RX
+	 * queue. Must be called before init(). Takes priority over the
+	 * standard RX queue, and has no effect on frames that are handled
+	 * immediately (see Options::handleStandardMsgsImmediately).
+	 * 
+	 * @param[in] boxes
+	 * Block of mailboxes to use (one per expected identifier)
+	 * 
+	 * @param[in] numBoxes
+	 * Number of mailboxes in boxes (max of MEGA_CAN_MAX_MAILBOXES)
+	 */
+	void
+	setMailboxes(
+		CAN_Mailbox *boxes,
+		uint8_t numBoxes)
+	{
+		mailboxes_.setup(boxes,numBoxes);
+	}
+
 	void
 	init();
 
@@ -225,6 +537,21 @@ public:
 		uint8_t len,
 		uint8_t *buf);
 
+	/**
+	 * Loads a new set of hardware masks/filters into the MCP2515 while
+	 * running (no need for a full init()). Frames that arrive while the
+	 * MCP2515 is in configuration mode are missed.
+	 * 
+	 * @param[in] plan
+	 * The mask/filter assignment (see FilterPlanner)
+	 * 
+	 * @return
+	 * True if successful, false otherwise.
+	 */
+	bool
+	applyFilterPlan(
+		const FilterPlan_t &plan);
+
 	uint8_t
 	canId() const
 	{
@@ -237,6 +564,77 @@ public:
 		return canStatus_;
 	}
 
+	/**
+	 * @return
+	 * The fault confinement state of the CAN interface (see
+	 * CAN_ERR_STATE_* defines)
+	 */
+	uint8_t
+	getErrorState()
+	{
+		return errState_;
+	}
+
+	/**
+	 * @param[in] state
+	 * One of the CAN_ERR_STATE_* defines
+	 * 
+	 * @return
+	 * Number of times the CAN interface entered the state (saturates)
+	 */
+	uint8_t
+	getErrorStateEntryCount(
+		uint8_t state)
+	{
+		return (state < CAN_NUM_ERR_STATES ? errStateEntryCounts_[state] : 0);
+	}
+
+	/**
+	 * @return
+	 * Number of times the MCP2515 was restarted because it didn't recover
+	 * from bus-off on its own
+	 */
+	uint8_t
+	getBusOffRestartCount()
+	{
+		return busOffRestartCount_;
+	}
+
+	// highest transmit error count seen since the last resetErrorCounters()
+	uint8_t
+	getPeakTEC()
+	{
+		return peakTEC_;
+	}
+
+	// highest receive error count seen since the last resetErrorCounters()
+	uint8_t
+	getPeakREC()
+	{
+		return peakREC_;
+	}
+
+	/**
+	 * Optional traffic (ie. realtime broadcasts) should be scaled down while
+	 * the bus is in trouble so that required traffic still gets through.
+	 * 
+	 * @return
+	 * 1 to send every optional frame, N to send every Nth, or 0 to send none
+	 */
+	uint8_t
+	optionalTxDivisor()
+	{
+		switch (errState_)
+		{
+			case CAN_ERR_STATE_PASSIVE:
+				return CAN_ERR_PASSIVE_TX_DIVISOR;
+			case CAN_ERR_STATE_BUS_OFF:
+				return 0;
+			default:
+				return 1;
+		}
+	}
+
 	uint8_t
 	getLogicErrorCount()
 	{
@@ -249,6 +647,28 @@ public:
 		return canSW_RxOverflowCount_;
 	}
 
+	/**
+	 * @return
+	 * Number of standard frames dropped because the standard RX queue was
+	 * full
+	 */
+	uint8_t
+	getSW_StdRxOverflowCount()
+	{
+		return canSW_StdRxOverflowCount_;
+	}
+
+	/**
+	 * @return
+	 * Number of standard frames dropped because their identifier didn't
+	 * have a mailbox and none were free
+	 */
+	uint8_t
+	getSW_MailboxOverflowCount()
+	{
+		return canSW_MailboxOverflowCount_;
+	}
+
 	uint8_t
 	getHW_Rx0_OverflowCount()
 	{
@@ -261,13 +681,130 @@ public:
 		return canHW_Rx1_OverflowCount_;
 	}
 
+	/**
+	 * @return
+	 * Number of frames the MCP2515 flagged with a message error (MERRF)
+	 */
+	uint8_t
+	getHW_MsgErrorCount()
+	{
+		return canHW_MsgErrorCount_;
+	}
+
+	/**
+	 * @return
+	 * Number of frames that couldn't be sent because the TX queue was full
+	 */
+	uint8_t
+	getSW_TxOverflowCount()
+	{
+		return canSW_TxOverflowCount_;
+	}
+
+	/**
+	 * @return
+	 * Total number of queued frames that the MCP2515 reported as sent
+	 */
+	uint32_t
+	getTxCompleteCount()
+	{
+		uint32_t count;
+		MC_ATOMIC_START
+		count = canTxCompleteCount_;
+		MC_ATOMIC_END
+		return count;
+	}
+
+	/**
+	 * @return
+	 * Total number of queued frames that were aborted after going unsent
+	 * for CAN_TX_TIMEOUT_MS
+	 */
+	uint32_t
+	getTxFailCount()
+	{
+		uint32_t count;
+		MC_ATOMIC_START
+		count = canTxFailCount_;
+		MC_ATOMIC_END
+		return count;
+	}
+
+	/**
+	 * @return
+	 * Average number of SPI transactions with the MCP2515 per received
+	 * frame (includes transmit and error handling transactions)
+	 */
+	float
+	getSPI_TransactionsPerRxFrame()
+	{
+		uint32_t txns;
+		uint32_t frames;
+		MC_ATOMIC_START
+		txns = can_.getSpiTransactionCount();
+		frames = can_.getRxFrameCount();
+		MC_ATOMIC_END
+		return (frames ? (float)(txns) / frames : 0.0f);
+	}
+
+#if MEGA_CAN_TELEMETRY
+	/**
+	 * @param[out] table
+	 * The current telemetry, as it's served over MSG_REQ from
+	 * TABLE_NO_TELEMETRY (multi-byte values are big endian)
+	 */
+	void
+	readTelemetry(
+		CAN_TelemetryTable_t &table)
+	{
+		MC_ATOMIC_START
+		telemetry_.snapshot(table);
+		MC_ATOMIC_END
+	}
+
+	void
+	resetTelemetry()
+	{
+		MC_ATOMIC_START
+		telemetry_.reset();
+		MC_ATOMIC_END
+	}
+#endif
+
+	/**
+	 * @return
+	 * Number of frames waiting in the TX queue or in the MCP2515's transmit
+	 * buffers
+	 */
+	uint8_t
+	getTxPendingCount()
+	{
+		uint8_t pending;
+		MC_ATOMIC_START
+		pending = txQueue_.size();
+		for (uint8_t b=txBusyMask_; b; b>>=1)
+		{
+			pending += b & 0x1;
+		}
+		MC_ATOMIC_END
+		return pending;
+	}
+
 	void
 	resetErrorCounters()
 	{
 		canLogicErrorCount_ = 0;
 		canSW_RxOverflowCount_ = 0;
+		canSW_StdRxOverflowCount_ = 0;
+		canSW_MailboxOverflowCount_ = 0;
 		canHW_Rx0_OverflowCount_ = 0;
 		canHW_Rx1_OverflowCount_ = 0;
+		canHW_MsgErrorCount_ = 0;
+		canSW_TxOverflowCount_ = 0;
+		memset((void*)(errStateEntryCounts_),0,sizeof(errStateEntryCounts_));
+		busOffRestartCount_ = 0;
+		peakTEC_ = 0;
+		peakREC_ = 0;
 	}
 
 protected:
@@ -379,11 +916,48 @@ protected:
 	 * 
 	 * @return
 	 * True if the burn was successful, false if not. Used to send MSG_BURNACK
+	 * (which is held back until burnInProgress() returns false)
 	 */
 	virtual bool
 	burnTable(
 			const uint8_t table);
 
+	/**
+	 * Overridable method for subclasses that burn flash in the background.
+	 * While this returns true, the MSG_BURNACK for the last successful
+	 * burnTable() call is deferred.
+	 * 
+	 * @return
+	 * True if a flash burn is still being written, false if not.
+	 */
+	virtual bool
+	burnInProgress();
+
+	/**
+	 * Called at the end of every handle() call. Subclasses can override this
+	 * to perform work that was deferred from an ISR to the main loop.
+	 */
+	virtual void
+	handleDeferred();
+
+	/**
+	 * Overridable method for subclass to implement. This method is called by
+	 * the base class when a MSG_CRC request was made to this CAN device.
+	 * 
+	 * @param[in] table
+	 * The table index to compute the CRC32 of
+	 * 
+	 * @param[out] crc
+	 * The CRC32 of the table's current contents
+	 * 
+	 * @return
+	 * True if the CRC is valid, false if not.
+	 */
+	virtual bool
+	tableCRC(
+			const uint8_t table,
+			uint32_t &crc);
+
 	/**
 	 * Called when a standard 11bit megasquirt broadcast frame is received.
 	 * 
@@ -402,6 +976,20 @@ protected:
 			const uint8_t length,
 			uint8_t *data);
 
+#if MEGA_CAN_RX_TIMESTAMPS
+	/**
+	 * @return
+	 * The MEGA_CAN_TIMESTAMP() of when the frame currently being handled
+	 * (ie. from within handleStandard()) was received. Frames that were
+	 * queued keep the timestamp of the interrupt that read them.
+	 */
+	uint32_t
+	rxTimestamp() const
+	{
+		return rxStamp_;
+	}
+#endif
+
 	void
 	simReqDrop(
 		uint8_t numReqsToDrop);
@@ -409,6 +997,31 @@ protected:
 private:
 	void
 	setupOptions();
+
+	/**
+	 * Called within CAN ISR to route a frame that was just read into the RX
+	 * queue's back slot (or overflowMsg_ if the queue is full).
+	 * 
+	 * @param[in] msg
+	 * The received CAN frame
+	 */
+	void
+	receive(
+			CAN_Msg *msg);
+
+	// handles every frame in the main RX queue (until it's empty)
+	void
+	drainQueue();
+
+	/**
+	 * Passes a received frame to handleExtended() or handleStandard().
+	 * 
+	 * @param[in] msg
+	 * The received CAN frame
+	 */
+	void
+	dispatch(
+			const CAN_Msg *msg);
 	
 	/**
 	 * Called when an extended 29bit megasquirt frame is received.
@@ -460,8 +1073,108 @@ private:
 			const uint8_t length,
 			uint8_t *data);
 
+	// holds back a successful MSG_BURNACK until no burn is in progress
+	void
+	queueBurnAck(
+			const uint8_t toId,
+			const uint8_t fromId);
+
+	// sends the queued MSG_BURNACKs once no burn is in progress
+	void
+	flushBurnAcks();
+
 	/**
-	 * Writes a CAN frame
+	 * Sends a MSG_BURNACK response.
+	 * 
+	 * @param[in] toId
+	 * The CAN id of the device that requested the burn
+	 * 
+	 * @param[in] fromId
+	 * The CAN id the burn request was addressed to
+	 * 
+	 * @param[in] burnOkay
+	 * True if the burn was successful, false if not
+	 */
+	void
+	sendBurnAck(
+			const uint8_t toId,
+			const uint8_t fromId,
+			const bool burnOkay);
+
+	/**
+	 * Loads frames from the TX queue into free MCP2515 transmit buffers.
+	 * Must be called with interrupts disabled (or from within the ISR).
+	 */
+	void
+	serviceTxQueue();
+
+	/**
+	 * Called from handle(). Aborts transmit buffers that have gone unsent
+	 * for CAN_TX_TIMEOUT_MS so that a frame nobody ACKs can't hold a buffer
+	 * forever. A buffer is only released (and counted as failed) once the
+	 * MCP2515 reports it as aborted.
+	 */
+	void
+	serviceTxTimeouts();
+
+	/**
+	 * Called from the error handlers (within the CAN ISR). Moves to a worse
+	 * error state; recovering is left to serviceErrorState().
+	 * 
+	 * @param[in] state
+	 * One of the CAN_ERR_STATE_* defines
+	 */
+	void
+	raiseErrorState(
+		uint8_t state);
+
+	/**
+	 * Changes the error state and counts the transition. Must be called
+	 * with interrupts disabled (or from within the ISR).
+	 * 
+	 * @param[in] state
+	 * One of the CAN_ERR_STATE_* defines
+	 */
+	void
+	setErrorState(
+		uint8_t state);
+
+	/**
+	 * Called from handle(). While the CAN interface isn't error active, the
+	 * error counters are polled (the MCP2515 only interrupts as they rise)
+	 * and a stuck bus-off is recovered from by restarting the MCP2515.
+	 */
+	void
+	serviceErrorState();
+
+	// aborts pending transmits and cycles the MCP2515 through config mode
+	void
+	restartAfterBusOff();
+
+	/**
+	 * Masks the external interrupt on the CAN interrupt pin so the CAN ISR
+	 * can't start SPI transactions in the middle of a multi-step MCP2515
+	 * update. Unlike MC_ATOMIC, every other interrupt (ie. millis()) keeps
+	 * running, so the MCP2515's mode change timeouts still expire. Pins
+	 * without an external interrupt are left alone.
+	 * 
+	 * @return
+	 * The EIMSK bits that were cleared. Pass them to unmaskCanInterrupt().
+	 */
+	uint8_t
+	maskCanInterrupt();
+
+	/**
+	 * @param[in] mask
+	 * The EIMSK bits returned by maskCanInterrupt()
+	 */
+	void
+	unmaskCanInterrupt(
+		uint8_t mask);
+
+	/**
+	 * Writes a CAN frame. If a TX queue was provided, the frame is queued
+	 * and this method never blocks. Must be called from the main loop.
 	 * 
 	 * @param[in] id
 	 * The 29bit or 11bit CAN indentifier
@@ -476,7 +1189,7 @@ private:
 	 * Pointer to the data to send
 	 * 
 	 * @return
-	 * True if successful, false otherwise.
+	 * True if the frame was sent (or queued), false otherwise.
 	 */
 	bool
 	sendMsgBuf(
@@ -501,6 +1214,23 @@ private:
 
 	// CAN RX Variables
 	CAN_MsgQueue queue_;
+	// frames are read into here when queue_ is full (and then dropped)
+	CAN_Msg overflowMsg_;
+	// optional queue dedicated to standard frames
+	CAN_MsgQueue stdQueue_;
+	// optional latest-frame-per-identifier store for standard frames
+	CAN_MailboxStore mailboxes_;
+
+	// CAN TX Variables
+	// main loop is the producer; consumer is the ISR (or main loop with
+	// interrupts disabled)
+	CAN_MsgQueue txQueue_;
+	// bit n set when MCP2515 TXBn is loaded and waiting to be sent
+	volatile uint8_t txBusyMask_;
+	// TXP priority of the most recently loaded transmit buffer
+	uint8_t txPrio_;
+	// millis() when each transmit buffer was loaded
+	uint16_t txLoadTime_[3];
 
 	// Status word for the CAN interface.
 	// see CAN_STATUS_* defines
@@ -509,16 +1239,64 @@ private:
 	// allow error handler callbacks to modify private error counters
 	friend void mega_can_rx0_ovr(MCP_CAN *can, void *varg);
 	friend void mega_can_rx1_ovr(MCP_CAN *can, void *varg);
+	friend void mega_can_tx_bo(MCP_CAN *can, void *varg);
+	friend void mega_can_tx_ep(MCP_CAN *can, void *varg, uint8_t tec);
+	friend void mega_can_rx_ep(MCP_CAN *can, void *varg, uint8_t rec);
+	friend void mega_can_e_warn(MCP_CAN *can, void *varg, uint8_t rec, uint8_t tec);
 
 	// Total number of CAN errors detected (counters saturate)
 	volatile uint8_t canLogicErrorCount_;
 	volatile uint8_t canSW_RxOverflowCount_;
+	volatile uint8_t canSW_StdRxOverflowCount_;
+	volatile uint8_t canSW_MailboxOverflowCount_;
 	volatile uint8_t canHW_Rx0_OverflowCount_;
 	volatile uint8_t canHW_Rx1_OverflowCount_;
+	volatile uint8_t canHW_MsgErrorCount_;
+	volatile uint8_t canSW_TxOverflowCount_;
+
+	// running count of frames sent from the TX queue
+	volatile uint32_t canTxCompleteCount_;
+	// running count of frames aborted by serviceTxTimeouts()
+	uint32_t canTxFailCount_;
+
+#if MEGA_CAN_TELEMETRY
+	// served as TABLE_NO_TELEMETRY
+	CAN_Telemetry telemetry_;
+#endif
+
+#if MEGA_CAN_RX_TIMESTAMPS
+	// receive timestamp of the frame being handled. the ISR restores the
+	// main loop's value before returning.
+	volatile uint32_t rxStamp_;
+#endif
+
+	// CAN fault confinement state (see CAN_ERR_STATE_* defines)
+	volatile uint8_t errState_;
+	// millis() when errState_ last changed
+	volatile uint32_t errStateTime_;
+	// millis() when the error counters were last polled
+	uint32_t errPollTime_;
+	// how long to stay bus-off before restarting the MCP2515
+	uint16_t busOffBackoffMs_;
+	// error state history (counters saturate)
+	volatile uint8_t errStateEntryCounts_[CAN_NUM_ERR_STATES];
+	uint8_t busOffRestartCount_;
+	volatile uint8_t peakTEC_;
+	volatile uint8_t peakREC_;
 
 	// debug feature to drop the next N req messages (don't send RSP)
 	uint8_t numSimReqDropsLeft_;
 
+	// successful MSG_BURNACKs that are waiting on a background burn to
+	// complete (in the order they were requested)
+	struct BurnAck
+	{
+		uint8_t toId;
+		uint8_t fromId;
+	};
+	BurnAck burnAcks_[MEGA_CAN_MAX_PENDING_BURN_ACKS];
+	uint8_t numBurnAcks_;
+
 	// Buffer of CAN frame data used for building responses
 	uint8_t txBuf_[8];
 
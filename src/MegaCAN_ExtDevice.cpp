@@ -1,14 +1,32 @@
 #include "MegaCAN_ExtDevice.h"
 
+#include "CrcUtils.h"
+#include "FlashUtils.h"
+
+#include <avr/eeprom.h>
 #include <avr/wdt.h>
-#include <EEPROM.h>
 
 namespace MegaCAN
 {
 
-// a place to temporarily store modified pages of flash
 uint8_t tempPage[MEGA_CAN_EXT_MAX_FLASH_TABLE_SIZE];
 
+// the device whose burn engine owns the EEPROM ready interrupt
+static ExtDevice *eeReadyDevice = nullptr;
+
+void
+mega_can_ee_ready()
+{
+	if (eeReadyDevice)
+	{
+		eeReadyDevice->eepromReady();
+	}
+	else
+	{
+		EECR &= ~_BV(EERIE);
+	}
+}
+
 ExtDevice::ExtDevice(
 		uint8_t cs,
 		uint8_t myId,
@@ -16,17 +34,111 @@ ExtDevice::ExtDevice(
 		CAN_Msg *buff,
 		uint8_t buffSize,
 		const TableDescriptor_t *tables,
-		uint8_t numTables)
- : MegaCAN::Device(cs,myId,intPin,buff,buffSize)
+		uint8_t numTables,
+		CAN_Msg *txBuff,
+		uint8_t txBuffSize,
+		FlashPage_t *pages,
+		uint8_t numPages)
+ : MegaCAN::Device(cs,myId,intPin,buff,buffSize,txBuff,txBuffSize)
  , tables_(tables)
  , numTables_(numTables)
- , currFlashTable_(numTables)
- , needsBurn_(false)
- , flashDataLost_(false)
+ , pages_(pages)
+ , numPages_(pages ? min(numPages, (uint8_t)(MEGA_CAN_EXT_MAX_FLASH_PAGES)) : 0)
+ , burnPage_(nullptr)
+ , burnWord_(0)
+ , burnedTable_(numTables)
+ , pendingBurns_(0)
+ , journal_(nullptr)
+ , crcValidMask_(0)
  , onTableWrittenCallback_(nullptr)
  , onTableBurnedCallback_(nullptr)
 {
-	memset(dirtyFlashBits_,0,MEGA_CAN_EXT_NUM_DIRTY_FLASH_WORDS);// reset all dirty bits
+	// all pages start empty. ages are a permutation of 0..numPages-1
+	for (uint8_t p=0; p<numPages_; p++)
+	{
+		pages_[p].table = numTables;
+		pages_[p].age = p;
+		pages_[p].dirty = false;
+		memset(pages_[p].dirtyBits,0,MEGA_CAN_EXT_NUM_DIRTY_FLASH_WORDS);// reset all dirty bits
+	}
+}
+
+// page for devices that don't provide their own (see the constructor below)
+static FlashPage_t sharedFlashPage;
+
+ExtDevice::ExtDevice(
+		uint8_t cs,
+		uint8_t myId,
+		uint8_t intPin,
+		CAN_Msg *buff,
+		uint8_t buffSize,
+		const TableDescriptor_t *tables,
+		uint8_t numTables,
+		CAN_Msg *txBuff,
+		uint8_t txBuffSize)
+ : ExtDevice(cs,myId,intPin,buff,buffSize,tables,numTables,txBuff,txBuffSize,&sharedFlashPage,1)
+{
+}
+
+bool
+ExtDevice::needsBurn() const
+{
+	for (uint8_t p=0; p<numPages_; p++)
+	{
+		if (pages_[p].dirty)
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+uint8_t
+ExtDevice::currFlashTable() const
+{
+	for (uint8_t p=0; p<numPages_; p++)
+	{
+		if (pages_[p].age == 0)
+		{
+			return pages_[p].table;
+		}
+	}
+	return numTables_;
+}
+
+bool
+ExtDevice::setJournal(
+	FlashJournal *journal)
+{
+	for (uint8_t t=0; journal && t<numTables_; t++)
+	{
+		const TableDescriptor_t &td = tables_[t];
+		if (td.tableType != TableType_E::eFlash)
+		{
+			continue;
+		}
+
+		const bool covered =
+			journal->covers(td.flashOffset) &&
+			journal->covers(td.flashOffset + td.tableSize - 1) &&
+			((td.flashOffset - journal->homeOffset()) % MEGA_CAN_JOURNAL_CHUNK_SIZE) == 0;
+		if ( ! covered)
+		{
+			ERROR("flash table %d isn't covered by the journal", t);
+			return false;
+		}
+	}
+
+	if (journal && journal->numSlots() == 0)
+	{
+		// burns rely on compaction always making room for another record
+		ERROR("journal has no record slots");
+		return false;
+	}
+
+	waitForBurn();
+	journal_ = journal;
+	return true;
 }
 
 bool
@@ -42,14 +154,14 @@ ExtDevice::readFromTable(
 		offset,
 		len);
 
-	if (table > numTables_)
+	if (table >= numTables_)
 	{
-		ERROR("%d > numTables_", table);
+		ERROR("%d >= numTables_", table);
 		return false;
 	}
 
 	const TableDescriptor_t &td = tables_[table];
-	if (td.tableData == nullptr)
+	if (td.tableType != TableType_E::eFlash && td.tableData == nullptr)
 	{
 		ERROR("null table %d", table);
 		return false;
@@ -60,19 +172,34 @@ ExtDevice::readFromTable(
 		return false;
 	}
 
-	// see if we need to load in a new table of flash
-	if (td.tableType == TableType_E::eFlash && currFlashTable_ != table)
+	if (td.tableType == TableType_E::eFlash)
 	{
-		if ( ! loadFlashTable(table))
+		FlashPage_t *page = findFlashPage(table);
+		if (page)
+		{
+			// return pointer to data within the RAM page
+			touchPage(page);
+			resData = page->data + offset;
+		}
+		else if (len <= sizeof(readBuff_))
+		{
+			// serve the requested range straight from EEPROM rather than
+			// loading (and possibly evicting) a whole page just to read it
+			FlashUtils::readBlock(td.flashOffset + offset, readBuff_, len);
+			resData = readBuff_;
+		}
+		else
 		{
+			ERROR("read of %dbytes exceeds read buffer", len);
 			return false;
 		}
 	}
+	else
+	{
+		// return pointer to data within table
+		resData = (uint8_t*)(td.tableData) + offset;
+	}
 
-	// return pointer to data within table
-	// Note: when tables are loaded in from flash tableData will point to RAM
-	resData = (uint8_t*)(td.tableData) + offset;
-		
 	return true;
 }
 
@@ -89,14 +216,14 @@ ExtDevice::writeToTable(
 		offset,
 		len);
 
-	if (table > numTables_)
+	if (table >= numTables_)
 	{
-		ERROR("%d > numTables_", table);
+		ERROR("%d >= numTables_", table);
 		return false;
 	}
 
 	const TableDescriptor_t &td = tables_[table];
-	if (td.tableData == nullptr)
+	if (td.tableType != TableType_E::eFlash && td.tableData == nullptr)
 	{
 		ERROR("null table %d", table);
 		return false;
@@ -108,23 +235,46 @@ ExtDevice::writeToTable(
 		return false;
 	}
 
-	// see if we need to load in a new table of flash
-	if (td.tableType == TableType_E::eFlash && currFlashTable_ != table)
+	if (td.tableType != TableType_E::eFlash)
 	{
-		if ( ! loadFlashTable(table))
+		memcpy((uint8_t*)(td.tableData) + offset, data, len);
+	}
+	else
+	{
+		FlashPage_t *page = getFlashPage(table);
+		if (page == nullptr)
 		{
 			return false;
 		}
-	}
 
-	// write data to temporary RAM location where flash was loaded
-	needsBurn_ = (td.tableType == TableType_E::eFlash) && (len > 0);
-	uint16_t flashOffset = offset;
-	for (uint8_t i=0; i<len; i++)
-	{
-		dirtyFlashBits_[flashOffset/8] |= 1<<(flashOffset%8);// update dirty bits
-		((uint8_t*)(td.tableData))[flashOffset] = data[i];
-		flashOffset++;
+		// patch the cached CRC with the bytes that are about to change
+		const uint8_t crcBit = (table < MEGA_CAN_EXT_MAX_CRC_TABLES ? 1 << table : 0);
+		const bool patchCRC = (crcValidMask_ & crcBit);
+		uint32_t crcDelta = 0;
+
+		// write data to the RAM page where flash was loaded
+		uint16_t flashOffset = offset;
+		for (uint8_t i=0; i<len; i++)
+		{
+			uint8_t &dst = page->data[flashOffset];
+			if (patchCRC)
+			{
+				crcDelta = CrcUtils::crc32RawByte(crcDelta, dst ^ data[i]);
+			}
+			dst = data[i];
+
+			// update dirty bits after the data so the burn engine never
+			// writes a stale byte (it clears bits from within the ISR)
+			MC_ATOMIC_START
+			page->dirtyBits[flashOffset/8] |= 1<<(flashOffset%8);
+			page->dirty = true;
+			MC_ATOMIC_END
+			flashOffset++;
+		}
+		if (patchCRC)
+		{
+			tableCRCs_[table] ^= CrcUtils::crc32RawZeros(crcDelta, td.tableSize - flashOffset);
+		}
 	}
 
 	// notify optional user callback
@@ -132,7 +282,7 @@ ExtDevice::writeToTable(
 	{
 		onTableWrittenCallback_(table,offset,len,data);
 	}
-		
+
 	return true;
 }
 
@@ -140,78 +290,487 @@ bool
 ExtDevice::burnTable(
 		const uint8_t table)
 {
-	if (table != currFlashTable_)
+	if (table >= numTables_)
 	{
-		ERROR("table to burn is %d but current is %d", table, currFlashTable_);
+		ERROR("invalid table %d", table);
 		return false;
 	}
-	else if (table >= numTables_)
+	else if (tables_[table].tableType != TableType_E::eFlash)
 	{
-		ERROR("invalid table %d", table);
+		ERROR("requested burn to non-flash table %d", table);
 		return false;
 	}
-	else if ( ! needsBurn_)
+
+	FlashPage_t *page = findFlashPage(table);
+	if (page == nullptr || ! page->dirty)
 	{
 		// be nice and don't use unecessary write cycles on flash
 		WARN("flash was never modified. ignoring burn request");
 		return true;
 	}
-	
+
+	// if this page is already burning, rescan it to pick up the new changes.
+	// the burn may complete (clearing burnPage_) at any moment, in which
+	// case a new burn is started below.
+	bool rescanned = false;
+	MC_ATOMIC_START
+	if (page == burnPage_)
+	{
+		burnWord_ = 0;
+		rescanned = true;
+	}
+	MC_ATOMIC_END
+	if (rescanned)
+	{
+		return true;
+	}
+
+	requestBurn(page);
+	return true;
+}
+
+bool
+ExtDevice::burnInProgress()
+{
+	return burnPage_ != nullptr || pendingBurns_ != 0;
+}
+
+void
+ExtDevice::handleDeferred()
+{
+	notifyBurned();
+	startPendingBurn();
+}
+
+bool
+ExtDevice::tableCRC(
+	const uint8_t table,
+	uint32_t &crc)
+{
+	if (table >= numTables_)
+	{
+		ERROR("invalid table %d", table);
+		return false;
+	}
+
 	const TableDescriptor_t &td = tables_[table];
 	if (td.tableType != TableType_E::eFlash)
 	{
-		ERROR("requested burn to non-flash table %d", table);
-		return false;
+		if (td.tableData == nullptr)
+		{
+			ERROR("null table %d", table);
+			return false;
+		}
+		crc = CrcUtils::crc32((const uint8_t*)(td.tableData), td.tableSize);
+		return true;
 	}
-	
-	// write modified table contents from RAM to flash
-	for (unsigned int i=0; i<td.tableSize; i++)
+
+	const uint8_t crcBit = (table < MEGA_CAN_EXT_MAX_CRC_TABLES ? 1 << table : 0);
+	if (crcValidMask_ & crcBit)
+	{
+		crc = tableCRCs_[table];
+		return true;
+	}
+
+	const FlashPage_t *page = findFlashPage(table);
+	if (page)
+	{
+		// RAM page holds any unburned modifications
+		crc = CrcUtils::crc32(page->data, td.tableSize);
+	}
+	else
 	{
-		if (dirtyFlashBits_[i/8] & (1<<(i%8)))
+		uint32_t reg = 0xFFFFFFFFUL;
+		uint8_t chunk[8];
+		for (uint16_t i=0; i<td.tableSize; i+=sizeof(chunk))
+		{
+			const uint8_t n = min(td.tableSize - i, (uint16_t)(sizeof(chunk)));
+			FlashUtils::readBlock(td.flashOffset + i, chunk, n);
+			reg = CrcUtils::crc32Raw(reg, chunk, n);
+		}
+		crc = ~reg;
+	}
+
+	if (crcBit)
+	{
+		tableCRCs_[table] = crc;
+		crcValidMask_ |= crcBit;
+	}
+	return true;
+}
+
+FlashPage_t *
+ExtDevice::getFlashPage(
+	const uint8_t table)
+{
+	FlashPage_t *page = findFlashPage(table);
+	if (page)
+	{
+		touchPage(page);
+		return page;
+	}
+
+	// replace the least recently used clean page. dirty pages (including
+	// the one being burned) hold modifications that aren't in EEPROM yet.
+	FlashPage_t *lru = nullptr;
+	for (uint8_t p=0; p<numPages_; p++)
+	{
+		FlashPage_t *cand = &pages_[p];
+		if ( ! cand->dirty && (page == nullptr || cand->age > page->age))
+		{
+			page = cand;
+		}
+		if (lru == nullptr || cand->age > lru->age)
 		{
-			// writing to EEPROM is slow (~3.4ms per byte)
-			// keep watchdog happy if user code uses it
-			wdt_reset();
+			lru = cand;
+		}
+	}
+	if (lru == nullptr)
+	{
+		ERROR("no flash pages to load table %d into", table);
+		return nullptr;
+	}
 
-			EEPROM.write(td.flashOffset + i, ((uint8_t*)(td.tableData))[i]);
+	if (page == nullptr)
+	{
+		// every page has unburned modifications. write the least recently
+		// used one back in the background rather than waiting on EEPROM.
+		INFO("burning table %d to free up its page", lru->table);
+		requestBurn(lru);
+		if (lru->dirty)
+		{
+			WARN("no clean flash page to load table %d into", table);
+			return nullptr;
 		}
+		page = lru;// burned synchronously
 	}
-	needsBurn_ = false;
-	memset(dirtyFlashBits_,0,MEGA_CAN_EXT_NUM_DIRTY_FLASH_WORDS);// reset all dirty bits
 
-	// notify optional user callback
-	if (onTableBurnedCallback_)
+	if ( ! loadFlashTable(page,table))
 	{
-		onTableBurnedCallback_(table);
+		return nullptr;
 	}
+	touchPage(page);
+	return page;
+}
 
-	return true;
+FlashPage_t *
+ExtDevice::findFlashPage(
+	const uint8_t table)
+{
+	for (uint8_t p=0; p<numPages_; p++)
+	{
+		if (pages_[p].table == table)
+		{
+			return &pages_[p];
+		}
+	}
+	return nullptr;
+}
+
+void
+ExtDevice::touchPage(
+	FlashPage_t *page)
+{
+	// age every page that was used more recently than this one
+	for (uint8_t p=0; p<numPages_; p++)
+	{
+		if (pages_[p].age < page->age)
+		{
+			pages_[p].age++;
+		}
+	}
+	page->age = 0;
 }
 
 bool
 ExtDevice::loadFlashTable(
+	FlashPage_t *page,
 	const uint8_t table)
 {
-	if (needsBurn_)
+	const TableDescriptor_t &td = tables_[table];
+	if (td.tableSize > MEGA_CAN_EXT_MAX_FLASH_TABLE_SIZE)
 	{
-		// TODO could be nice and write to flash, but hoping TunerStudio
-		// is smart enough to not put us in here. We'll see...
-		WARN("unburned flash contents being lost");
-		flashDataLost_ = true;
+		ERROR("flash table %d is too large (%dbytes)", table, td.tableSize);
+		return false;
 	}
 
 	// load flash table contents into RAM
-	const TableDescriptor_t &td = tables_[table];
-	for (unsigned int i=0; i<td.tableSize; i++)
+	FlashUtils::readBlock(td.flashOffset, page->data, td.tableSize);
+	if (table < MEGA_CAN_EXT_MAX_CRC_TABLES)
 	{
-		((uint8_t*)(td.tableData))[i] = EEPROM.read(td.flashOffset + i);
+		tableCRCs_[table] = CrcUtils::crc32(page->data, td.tableSize);
+		crcValidMask_ |= 1 << table;
 	}
-	currFlashTable_ = table;
-	needsBurn_ = false;
-	memset(dirtyFlashBits_,0,MEGA_CAN_EXT_NUM_DIRTY_FLASH_WORDS);// reset all dirty bits
+	page->table = table;
+	page->dirty = false;
+	memset(page->dirtyBits,0,MEGA_CAN_EXT_NUM_DIRTY_FLASH_WORDS);// reset all dirty bits
 	DEBUG("loaded %dbytes from flash table %d", td.tableSize, table);
-	
+
 	return true;
 }
 
+void
+ExtDevice::startBurn(
+	FlashPage_t *page)
+{
+	// don't lose track of a previously completed burn
+	notifyBurned();
+
+	burnWord_ = 0;
+	burnPage_ = page;
+	eeReadyDevice = this;
+	DEBUG("burning table %d", page->table);
+
+#if MEGA_CAN_EXT_ASYNC_BURN
+	// EEPROM ready interrupt fires as soon as the EEPROM is idle
+	MC_ATOMIC_START
+	EECR |= _BV(EERIE);
+	MC_ATOMIC_END
+#else
+	while (burnPage_ != nullptr)
+	{
+		// writing to EEPROM is slow (~3.4ms per byte)
+		// keep watchdog happy if user code uses it
+		wdt_reset();
+		eeprom_busy_wait();
+		eepromReady();
+	}
+	notifyBurned();
+#endif
+}
+
+void
+ExtDevice::requestBurn(
+	FlashPage_t *page)
+{
+	if (page == burnPage_)
+	{
+		return;
+	}
+	else if (burnPage_ != nullptr)
+	{
+		// started from handle() once the running burn completes
+		DEBUG("table %d waits on burn of another table", page->table);
+		pendingBurns_ |= 1 << (page - pages_);
+		return;
+	}
+	startBurn(page);
+}
+
+void
+ExtDevice::startPendingBurn()
+{
+	if (pendingBurns_ == 0 || burnPage_ != nullptr)
+	{
+		return;
+	}
+
+	for (uint8_t p=0; p<numPages_; p++)
+	{
+		const uint8_t bit = 1 << p;
+		if (pendingBurns_ & bit)
+		{
+			pendingBurns_ &= ~bit;
+			startBurn(&pages_[p]);
+			return;
+		}
+	}
+}
+
+void
+ExtDevice::waitForBurn()
+{
+	while (burnInProgress())
+	{
+		// keep watchdog happy if user code uses it
+		wdt_reset();
+		startPendingBurn();
+	}
+	notifyBurned();
+}
+
+void
+ExtDevice::notifyBurned()
+{
+	const uint8_t table = burnedTable_;
+	if (table >= numTables_)
+	{
+		return;
+	}
+	burnedTable_ = numTables_;
+
+	// cached copies of the table's flash are now stale. its CRC isn't; it
+	// was kept up to date as the page was modified.
+	const uint8_t crcValidMask = crcValidMask_;
+	FlashUtils::invalidateCaches(tables_[table].flashOffset, tables_[table].tableSize);
+	crcValidMask_ = crcValidMask;
+
+	// notify optional user callback
+	if (onTableBurnedCallback_)
+	{
+		onTableBurnedCallback_(table);
+	}
+}
+
+bool
+ExtDevice::overlaps(
+	const fsize_t offset,
+	const fsize_t len) const
+{
+	for (uint8_t t=0; t<numTables_; t++)
+	{
+		const TableDescriptor_t &td = tables_[t];
+		if (td.tableType == TableType_E::eFlash &&
+			offset < (td.flashOffset + td.tableSize) &&
+			td.flashOffset < (offset + len))
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+void
+ExtDevice::invalidateRange(
+	const fsize_t offset,
+	const fsize_t len)
+{
+	for (uint8_t t=0; t<numTables_ && t<MEGA_CAN_EXT_MAX_CRC_TABLES; t++)
+	{
+		const TableDescriptor_t &td = tables_[t];
+		if (td.tableType == TableType_E::eFlash &&
+			offset < (td.flashOffset + td.tableSize) &&
+			td.flashOffset < (offset + len))
+		{
+			crcValidMask_ &= ~(1 << t);
+		}
+	}
+}
+
+void
+ExtDevice::eepromReady()
+{
+	FlashPage_t *page = burnPage_;
+	if (page == nullptr)
+	{
+		EECR &= ~_BV(EERIE);
+		return;
+	}
+
+	if (journal_ ? burnNextChunk(page) : burnNextByte(page))
+	{
+		return;// resume when EEPROM is ready again
+	}
+
+	// burn complete. page stays dirty if it was modified during the burn
+	uint8_t dirtyBits = 0;
+	for (uint8_t w=0; w<MEGA_CAN_EXT_NUM_DIRTY_FLASH_WORDS; w++)
+	{
+		dirtyBits |= page->dirtyBits[w];
+	}
+	page->dirty = (dirtyBits != 0);
+	burnedTable_ = page->table;
+	burnPage_ = nullptr;
+	EECR &= ~_BV(EERIE);
+}
+
+bool
+ExtDevice::burnNextByte(
+	FlashPage_t *page)
+{
+	const fsize_t flashOffset = tables_[page->table].flashOffset;
+	uint8_t word = burnWord_;
+	while (word < MEGA_CAN_EXT_NUM_DIRTY_FLASH_WORDS)
+	{
+		const uint8_t bits = page->dirtyBits[word];
+		if (bits == 0)
+		{
+			// skip a whole word of unmodified bytes
+			word++;
+			continue;
+		}
+
+		// take the lowest dirty byte within the word
+		const uint8_t lsb = bits & -bits;
+		page->dirtyBits[word] = bits ^ lsb;
+		uint8_t i = word * 8;
+		for (uint8_t m=lsb; m>>=1;)
+		{
+			i++;
+		}
+
+		// don't spend a write cycle on bytes that already match
+		uint8_t *addr = (uint8_t *)(flashOffset + i);
+		if (eeprom_read_byte(addr) != page->data[i])
+		{
+			eeprom_write_byte(addr, page->data[i]);
+			burnWord_ = word;
+			return true;
+		}
+	}
+	burnWord_ = word;
+	return false;
+}
+
+bool
+ExtDevice::burnNextChunk(
+	FlashPage_t *page)
+{
+	if (journal_->compactStep() || journal_->writeStaged())
+	{
+		return true;
+	}
+
+	// each word of dirty bits covers exactly one journal chunk
+	static_assert(MEGA_CAN_JOURNAL_CHUNK_SIZE == 8, "dirty words must map to journal chunks");
+	const TableDescriptor_t &td = tables_[page->table];
+	uint8_t word = burnWord_;
+	while (word < MEGA_CAN_EXT_NUM_DIRTY_FLASH_WORDS)
+	{
+		if (page->dirtyBits[word] == 0)
+		{
+			word++;
+			continue;
+		}
+		else if (journal_->freeSlots() == 0)
+		{
+			// out of room. compact (a byte per EEPROM ready interrupt) and
+			// then carry on with this word
+			journal_->startCompaction();
+			burnWord_ = word;
+			if (journal_->compactStep())
+			{
+				return true;
+			}
+			continue;
+		}
+		page->dirtyBits[word] = 0;
+
+		// bytes past the end of the table belong to whatever follows it
+		const fsize_t chunkOffset = td.flashOffset + word * MEGA_CAN_JOURNAL_CHUNK_SIZE;
+		uint8_t data[MEGA_CAN_JOURNAL_CHUNK_SIZE];
+		for (uint8_t j=0; j<MEGA_CAN_JOURNAL_CHUNK_SIZE; j++)
+		{
+			const uint16_t i = word * MEGA_CAN_JOURNAL_CHUNK_SIZE + j;
+			data[j] = (i < td.tableSize ? page->data[i] : journal_->readRaw(chunkOffset + j));
+		}
+
+		word++;
+		if (journal_->stage(journal_->chunkOf(chunkOffset), data) && journal_->writeStaged())
+		{
+			burnWord_ = word;
+			return true;
+		}
+	}
+	burnWord_ = word;
+	return false;
+}
+
 }// namespace - MegaCAN
+
+#if MEGA_CAN_EXT_ASYNC_BURN
+ISR(EE_READY_vect)
+{
+	MegaCAN::mega_can_ee_ready();
+}
+#endif
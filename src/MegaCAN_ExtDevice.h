@@ -3,6 +3,7 @@
 
 #include "MegaCAN_ExtTypes.h"
 #include "MegaCAN_Device.h"
+#include "MegaCAN_FlashJournal.h"
 
 namespace MegaCAN
 {
@@ -11,13 +12,60 @@ namespace MegaCAN
 #define MEGA_CAN_EXT_MAX_FLASH_TABLE_SIZE 128
 #define MEGA_CAN_EXT_NUM_DIRTY_FLASH_WORDS (MEGA_CAN_EXT_MAX_FLASH_TABLE_SIZE / 8)// 8bits per bytes
 
+// set to 0 to burn flash tables synchronously within handle() instead of in
+// the background from the EEPROM ready interrupt (EE_READY_vect). When set
+// to 1 the library defines the EE_READY_vect ISR.
+#define MEGA_CAN_EXT_ASYNC_BURN 1
+
+// max number of flash pages (burns waiting on another are tracked in a bitmask)
+#define MEGA_CAN_EXT_MAX_FLASH_PAGES 8
+
+// max number of bytes read/written per request (also sizes the buffer that
+// reads of non-resident flash tables are served from)
+#define MEGA_CAN_EXT_BLOCKING_FACTOR 32
+
+// number of flash tables that get their CRC32 cached (tables beyond this are
+// recomputed on every MSG_CRC request)
+#define MEGA_CAN_EXT_MAX_CRC_TABLES 8
+
 static_assert((MEGA_CAN_EXT_MAX_FLASH_TABLE_SIZE % 8) == 0,
 		"Max flash table size must be a multiple of 8 bytes");
 
-// a place to temporarily store modified pages of flash
-extern uint8_t tempPage[MEGA_CAN_EXT_MAX_FLASH_TABLE_SIZE];
+// flash tables used to be loaded into this buffer. tableData is ignored for
+// flash tables now, so older sketches can keep listing it (it's dropped by
+// the linker once nothing references it).
+extern uint8_t tempPage[MEGA_CAN_EXT_MAX_FLASH_TABLE_SIZE]
+	__attribute__((deprecated("tableData is ignored for flash tables. use nullptr")));
+
+/**
+ * A RAM slot that holds a copy of one flash table. The user provides an
+ * array of these to the ExtDevice so that multiple flash tables can be
+ * resident (and modified) at once.
+ */
+struct FlashPage_t
+{
+	// copy of the flash table's contents (including unburned modifications)
+	uint8_t data[MEGA_CAN_EXT_MAX_FLASH_TABLE_SIZE];
+
+	/**
+	 * A bitmask of which bytes in the page have been modified in RAM, but
+	 * not yet burned. This is used to only burn the bytes that were
+	 * modified in effort to reduce the total number of write cycles we put
+	 * on the EEPROM.
+	 */
+	uint8_t dirtyBits[MEGA_CAN_EXT_NUM_DIRTY_FLASH_WORDS];
+
+	// table that's loaded into this page (>= numTables if empty)
+	uint8_t table;
+
+	// LRU age of the page (0 is the most recently used)
+	uint8_t age;
 
-class ExtDevice : public MegaCAN::Device
+	// true if any of the dirtyBits are set (stays set while being burned)
+	bool dirty;
+};
+
+class ExtDevice : public MegaCAN::Device, private FlashUtils::FlashCache
 {
 public:
 	using OnTableWrittenCallback = void (*)(
@@ -29,6 +77,31 @@ public:
 		uint8_t /*table*/);
 	
 public:
+	/**
+	 * @param[in] pages
+	 * RAM slots that flash tables are loaded into (see FlashPage_t)
+	 *
+	 * @param[in] numPages
+	 * Number of flash pages (at most MEGA_CAN_EXT_MAX_FLASH_PAGES)
+	 */
+	ExtDevice(
+			uint8_t cs,
+			uint8_t myId,
+			uint8_t intPin,
+			CAN_Msg *buff,
+			uint8_t buffSize,
+			const TableDescriptor_t *tables,
+			uint8_t numTables,
+			CAN_Msg *txBuff,
+			uint8_t txBuffSize,
+			FlashPage_t *pages,
+			uint8_t numPages);
+
+	/**
+	 * Loads flash tables into a single page that's shared by every
+	 * ExtDevice constructed this way (the page is only linked in when this
+	 * constructor is used).
+	 */
 	ExtDevice(
 			uint8_t cs,
 			uint8_t myId,
@@ -36,25 +109,53 @@ public:
 			CAN_Msg *buff,
 			uint8_t buffSize,
 			const TableDescriptor_t *tables,
-			uint8_t numTables);
+			uint8_t numTables,
+			CAN_Msg *txBuff = nullptr,
+			uint8_t txBuffSize = 0);
 
+	/**
+	 * @return
+	 * True if any of the resident flash pages have been modified, but
+	 * not yet burned.
+	 */
 	bool
-	needsBurn() const
-	{
-		return needsBurn_;
-	}
+	needsBurn() const;
+
+	/**
+	 * @return
+	 * The most recently accessed flash table that's loaded into RAM, or
+	 * the number of tables if no flash table is loaded.
+	 */
+	uint8_t
+	currFlashTable() const;
 
+	/**
+	 * @return
+	 * Always false. Modified flash tables are kept in a page (or burned)
+	 * rather than being discarded when another table is loaded.
+	 */
+	__attribute__((deprecated("modified flash tables are never discarded")))
 	bool
 	flashDataLost() const
 	{
-		return flashDataLost_;
+		return false;
 	}
 
-	uint8_t
-	currFlashTable() const
-	{
-		return currFlashTable_;
-	}
+	/**
+	 * Stores burned flash tables through a journal rather than rewriting
+	 * them in place. The journal must have been begin()'d and every flash
+	 * table must be within its home region (aligned to a journal chunk).
+	 * Call at startup before any tables are accessed.
+	 *
+	 * @param[in] journal
+	 * The journal to burn through (or nullptr to burn in place)
+	 *
+	 * @return
+	 * True if the journal can store all of the flash tables, false if not.
+	 */
+	bool
+	setJournal(
+		FlashJournal *journal);
 
 	void
 	setOnTableWrittenCallback(
@@ -86,7 +187,9 @@ protected:
 	 * The number of bytes to read
 	 *
 	 * @param[out] resData
-	 * A pointer to the corresponding memory to read from
+	 * A pointer to the corresponding memory to read from. Flash tables that
+	 * aren't loaded into a page are read into a buffer that's only valid
+	 * until the next read.
 	 *
 	 * @return
 	 * True if the read is valid, false if not.
@@ -105,28 +208,144 @@ protected:
 		const uint8_t len,
 		const uint8_t *data) override;
 
-	// called by base class when we should burn the current flash table
+	/**
+	 * Called by base class when we should burn a flash table. The burn is
+	 * started in the background. If a different table is still being
+	 * burned, this one is started after it from handle(). MSG_BURNACKs are
+	 * held back until every requested burn has completed.
+	 */
 	virtual bool
 	burnTable(
 			const uint8_t table) override;
+
+	virtual bool
+	burnInProgress() override;
+
+	// notifies the OnTableBurnedCallback of completed background burns
+	virtual void
+	handleDeferred() override;
+	
+	/**
+	 * Flash table CRCs are cached and patched incrementally as the table
+	 * is written, so a MSG_CRC request doesn't have to walk the EEPROM.
+	 * RAM tables are computed on demand.
+	 */
+	virtual bool
+	tableCRC(
+		const uint8_t table,
+		uint32_t &crc) override;
 	
 	virtual uint16_t
 	tableBlockingFactor() override
 	{
-		return 32;
+		return MEGA_CAN_EXT_BLOCKING_FACTOR;
 	}
 	
 	virtual uint16_t
 	writeBlockingFactor() override
 	{
-		return 32;
+		return MEGA_CAN_EXT_BLOCKING_FACTOR;
 	}
 
 private:
+	/**
+	 * Returns the page that holds a flash table, loading it from EEPROM
+	 * into the least recently used clean page if it's not resident yet.
+	 * If every page has unburned modifications, the least recently used
+	 * one is burned in the background and nullptr is returned until that
+	 * burn frees it up.
+	 *
+	 * @param[in] table
+	 * The flash table to get the page for
+	 *
+	 * @return
+	 * A pointer to the page, or nullptr on failure
+	 */
+	FlashPage_t *
+	getFlashPage(
+		const uint8_t table);
+
+	// returns the page holding the table, or nullptr if it's not resident
+	FlashPage_t *
+	findFlashPage(
+		const uint8_t table);
+
+	// marks a page as the most recently used
+	void
+	touchPage(
+		FlashPage_t *page);
+
 	bool
 	loadFlashTable(
+		FlashPage_t *page,
 		const uint8_t table);
 
+	/**
+	 * Starts writing a page's modified bytes to EEPROM. The dirty bits are
+	 * cleared as each byte is written. Bytes whose EEPROM contents already
+	 * match are skipped. Must not be called while another burn is running.
+	 */
+	void
+	startBurn(
+		FlashPage_t *page);
+
+	// starts burning a page, or marks it pending if another page is burning
+	void
+	requestBurn(
+		FlashPage_t *page);
+
+	// starts burning the next pending page if the burn engine is idle
+	void
+	startPendingBurn();
+
+	// blocks until the background burns (if any) have completed
+	void
+	waitForBurn();
+
+	// calls the OnTableBurnedCallback if a burn completed since last time
+	void
+	notifyBurned();
+
+	// true if any flash table is stored within the range
+	virtual bool
+	overlaps(
+		const fsize_t offset,
+		const fsize_t len) const override;
+
+	/**
+	 * Drops the cached CRCs of the flash tables stored within a range of
+	 * flash that was rewritten outside of writeToTable() (ie. through
+	 * FlashUtils::writeByte()).
+	 */
+	virtual void
+	invalidateRange(
+		const fsize_t offset,
+		const fsize_t len) override;
+
+	/**
+	 * Steps the burn engine. Called from the EEPROM ready ISR each time the
+	 * EEPROM finishes writing a byte (or in a loop when burning synchronously).
+	 */
+	void
+	eepromReady();
+
+	/**
+	 * Burn engine steps for in place and journaled storage.
+	 *
+	 * @return
+	 * True if an EEPROM write was started, false if there's nothing left
+	 * to write.
+	 */
+	bool
+	burnNextByte(
+		FlashPage_t *page);
+
+	bool
+	burnNextChunk(
+		FlashPage_t *page);
+
+	friend void mega_can_ee_ready();
+
 private:
 	/**
 	 * An array of table descriptors used to read/write data to RAM
@@ -136,30 +355,37 @@ private:
 	uint8_t numTables_;
 	
 	/**
-	 * The current table of flash that's loaded into RAM
+	 * RAM pages that flash tables are loaded into. Pages are replaced in
+	 * least recently used order.
 	 */
-	uint8_t currFlashTable_;
-	
-	/**
-	 * flag set true when a flash table has been loaded into RAM and
-	 * modified, but not yet burned. This flag is cleared once the
-	 * flash table has been burned via a MSG_BURN request.
-	 */
-	bool needsBurn_;
+	FlashPage_t *pages_;
+	uint8_t numPages_;
 
-	/**
-	 * A bitmask of which bytes in the active flash table have been
-	 * modified in RAM, but not yet burned. This table is used to
-	 * only burn the words that were modified in effort to reduce
-	 * the total number of write cycles we put on the EEPROM.
-	 */
-	uint8_t dirtyFlashBits_[MEGA_CAN_EXT_NUM_DIRTY_FLASH_WORDS];
+	// page being written to EEPROM by the burn engine (nullptr when idle)
+	FlashPage_t * volatile burnPage_;
+
+	// next word of burnPage_'s dirtyBits for the burn engine to scan
+	volatile uint8_t burnWord_;
+
+	// table whose burn completed, but hasn't been notified yet (numTables if none)
+	volatile uint8_t burnedTable_;
+
+	// bitmask of pages that are waiting for burnPage_ to complete
+	uint8_t pendingBurns_;
+
+	// optional journal that burns are appended to
+	FlashJournal *journal_;
+
+	// reads of flash tables that aren't loaded into a page are served from here
+	uint8_t readBuff_[MEGA_CAN_EXT_BLOCKING_FACTOR];
 
 	/**
-	 * set to true when a flash table was modified and then swapped out
-	 * for another table prior to receiving a MSG_BURN request
+	 * Cached CRC32 of each flash table's current contents (including
+	 * unburned modifications). Entries are only valid if their bit is
+	 * set within crcValidMask_.
 	 */
-	bool flashDataLost_;
+	uint32_t tableCRCs_[MEGA_CAN_EXT_MAX_CRC_TABLES];
+	uint8_t crcValidMask_;
 
 	// optional user callbacks when a table has been written/burned
 	OnTableWrittenCallback onTableWrittenCallback_;
@@ -0,0 +1,423 @@
+#include "MegaCAN_FilterPlanner.h"
+
+#include "logging.h"
+#include "MSG_defn.h"
+
+#include <string.h>
+
+namespace MegaCAN
+{
+
+#define STD_ID_MASK 0x7FF
+#define STD_ID_BITS 11
+
+// filters that belong to each receive buffer
+static const uint8_t BUFF_FILTER_START[2] = {0, 2};
+static const uint8_t BUFF_NUM_FILTERS[2] = {2, 4};
+
+// the standard (11bit) mask and filters assigned to a receive buffer
+struct StdBuffPlan_t
+{
+	uint16_t mask;
+	uint16_t filters[4];
+	uint8_t numFilters;
+};
+
+static uint8_t
+popCount(
+		uint16_t v)
+{
+	uint8_t count = 0;
+	for (; v; v &= v - 1)
+	{
+		count++;
+	}
+	return count;
+}
+
+// insertion sorts values and removes duplicates
+static void
+sortUnique(
+		uint16_t *values,
+		uint8_t &n)
+{
+	for (uint8_t i=1; i<n; i++)
+	{
+		const uint16_t v = values[i];
+		uint8_t j = i;
+		for (; j > 0 && values[j - 1] > v; j--)
+		{
+			values[j] = values[j - 1];
+		}
+		values[j] = v;
+	}
+
+	uint8_t unique = (n ? 1 : 0);
+	for (uint8_t i=1; i<n; i++)
+	{
+		if (values[i] != values[unique - 1])
+		{
+			values[unique++] = values[i];
+		}
+	}
+	n = unique;
+}
+
+static bool
+contains(
+		const uint16_t *sorted,
+		const uint8_t n,
+		const uint16_t v)
+{
+	uint8_t lo = 0;
+	uint8_t hi = n;
+	while (lo < hi)
+	{
+		const uint8_t mid = (lo + hi) >> 1;
+		if (sorted[mid] < v)
+		{
+			lo = mid + 1;
+		}
+		else
+		{
+			hi = mid;
+		}
+	}
+	return lo < n && sorted[lo] == v;
+}
+
+/**
+ * Finds a mask that lets all ids be matched by at most maxFilters filters.
+ *
+ * @return
+ * The number of 11bit identifiers the mask and filters accept
+ */
+static uint16_t
+cover(
+		const uint16_t *ids,
+		const uint8_t n,
+		const uint8_t maxFilters,
+		uint16_t &mask,
+		uint16_t *filters,
+		uint8_t &numFilters)
+{
+	uint16_t values[MEGA_CAN_FILTER_PLAN_MAX_IDS];
+	uint8_t numValues = n;
+	memcpy(values,ids,n * sizeof(uint16_t));
+	sortUnique(values,numValues);
+
+	uint16_t dontCare = 0;
+	while (numValues > maxFilters)
+	{
+		// every candidate bit doubles the accepted identifiers, so pick the
+		// one that merges the most filters together
+		uint16_t bestBit = 0;
+		uint8_t bestMerges = 0;
+		for (uint8_t b=0; b<STD_ID_BITS; b++)
+		{
+			const uint16_t bit = 1u << b;
+			if (dontCare & bit)
+			{
+				continue;
+			}
+
+			uint8_t merges = 0;
+			for (uint8_t i=0; i<numValues; i++)
+			{
+				if ((values[i] & bit) && contains(values,numValues,values[i] & ~bit))
+				{
+					merges++;
+				}
+			}
+			if (merges > bestMerges)
+			{
+				bestBit = bit;
+				bestMerges = merges;
+			}
+		}
+
+		if (bestBit == 0)
+		{
+			// no single bit merges anything. merge the closest pair instead
+			uint16_t bestDiff = STD_ID_MASK;
+			for (uint8_t i=0; i<numValues; i++)
+			{
+				for (uint8_t j=i+1; j<numValues; j++)
+				{
+					const uint16_t diff = values[i] ^ values[j];
+					if (popCount(diff) < popCount(bestDiff))
+					{
+						bestDiff = diff;
+					}
+				}
+			}
+			bestBit = bestDiff;
+		}
+
+		dontCare |= bestBit;
+		for (uint8_t i=0; i<numValues; i++)
+		{
+			values[i] &= ~dontCare;
+		}
+		sortUnique(values,numValues);
+	}
+
+	mask = ~dontCare & STD_ID_MASK;
+	memcpy(filters,values,numValues * sizeof(uint16_t));
+	numFilters = numValues;
+	return (uint16_t)(numValues) << popCount(dontCare);
+}
+
+// counts the 11bit identifiers that pass either buffer's filters
+static uint16_t
+countAccepts(
+		const StdBuffPlan_t *buffs,
+		const uint8_t numBuffs)
+{
+	// a buffer's filters are distinct under its mask, so each one passes
+	// its own 2^(don't care bits) identifiers
+	uint16_t accepts = 0;
+	for (uint8_t b=0; b<numBuffs; b++)
+	{
+		accepts += (uint16_t)(buffs[b].numFilters) << popCount(~buffs[b].mask & STD_ID_MASK);
+	}
+	if (numBuffs < 2)
+	{
+		return accepts;
+	}
+
+	// don't count identifiers that pass both buffers twice. a pair of
+	// filters overlaps if they agree on the bits that both masks check.
+	const uint16_t bothCare = buffs[0].mask & buffs[1].mask;
+	const uint16_t overlap = 1u << popCount(~(buffs[0].mask | buffs[1].mask) & STD_ID_MASK);
+	for (uint8_t f0=0; f0<buffs[0].numFilters; f0++)
+	{
+		for (uint8_t f1=0; f1<buffs[1].numFilters; f1++)
+		{
+			if (((buffs[0].filters[f0] ^ buffs[1].filters[f1]) & bothCare) == 0)
+			{
+				accepts -= overlap;
+			}
+		}
+	}
+	return accepts;
+}
+
+static void
+writeStdBuff(
+		FilterPlan_t &plan,
+		const uint8_t buff,
+		const StdBuffPlan_t &stdPlan)
+{
+	// low 16bits are left clear so the data bytes of standard frames
+	// (which the MCP2515 also compares against) are don't cares
+	plan.masks[buff] = (uint32_t)(stdPlan.mask) << 16;
+	plan.extMasks &= ~(1 << buff);
+	for (uint8_t f=0; f<BUFF_NUM_FILTERS[buff]; f++)
+	{
+		// unused filters repeat the first one
+		const uint16_t filt = stdPlan.filters[f < stdPlan.numFilters ? f : 0];
+		const uint8_t filtIdx = BUFF_FILTER_START[buff] + f;
+		plan.filters[filtIdx] = (uint32_t)(filt) << 16;
+		plan.extFilters &= ~(1 << filtIdx);
+	}
+}
+
+static void
+writeExtBuff(
+		FilterPlan_t &plan,
+		const uint8_t buff,
+		const uint8_t toId)
+{
+	// only check the 4bit toId in the megasquirt header
+	uint32_t mask = 0x0;
+	uint32_t filt = 0x0;
+	MS_HDR_t *maskHdr = reinterpret_cast<MS_HDR_t*>(&mask);
+	MS_HDR_t *filtHdr = reinterpret_cast<MS_HDR_t*>(&filt);
+	maskHdr->toId = 0xf;
+	filtHdr->toId = toId & 0xf;
+
+	plan.masks[buff] = mask;
+	plan.extMasks |= (1 << buff);
+	for (uint8_t f=0; f<BUFF_NUM_FILTERS[buff]; f++)
+	{
+		const uint8_t filtIdx = BUFF_FILTER_START[buff] + f;
+		plan.filters[filtIdx] = filt;
+		plan.extFilters |= (1 << filtIdx);
+	}
+}
+
+FilterPlanner::FilterPlanner()
+{
+	clear();
+}
+
+void
+FilterPlanner::clear()
+{
+	numIds_ = 0;
+	extEnabled_ = false;
+	extToId_ = 0;
+}
+
+bool
+FilterPlanner::acceptStd(
+		const uint16_t id)
+{
+	if (id > STD_ID_MASK)
+	{
+		WARN("0x%x isn't an 11bit identifier", id);
+		return false;
+	}
+	else if (contains(ids_,numIds_,id))
+	{
+		return true;
+	}
+	else if (numIds_ >= MEGA_CAN_FILTER_PLAN_MAX_IDS)
+	{
+		WARN("can't accept 0x%x. filter planner is full", id);
+		return false;
+	}
+
+	// keep ids sorted
+	uint8_t i = numIds_++;
+	for (; i > 0 && ids_[i - 1] > id; i--)
+	{
+		ids_[i] = ids_[i - 1];
+	}
+	ids_[i] = id;
+	return true;
+}
+
+bool
+FilterPlanner::acceptStdRange(
+		const uint16_t first,
+		const uint16_t last)
+{
+	if (first > last || last > STD_ID_MASK)
+	{
+		WARN("invalid 11bit identifier range 0x%x to 0x%x", first, last);
+		return false;
+	}
+
+	for (uint16_t id=first; id<=last; id++)
+	{
+		if ( ! acceptStd(id))
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+void
+FilterPlanner::acceptExtToId(
+		const uint8_t toId)
+{
+	extEnabled_ = true;
+	extToId_ = toId;
+}
+
+bool
+FilterPlanner::plan(
+		FilterPlan_t &plan) const
+{
+	memset(&plan,0,sizeof(plan));
+	if (numIds_ == 0 && ! extEnabled_)
+	{
+		WARN("nothing to plan filters for");
+		return false;
+	}
+
+	if (extEnabled_)
+	{
+		// 29bit frames compare the toId against the EID bits, which standard
+		// frames would compare against their data bytes. RXB0 gets the 29bit
+		// frames, which leaves RXB1's 4 filters for the 11bit ones.
+		writeExtBuff(plan,0,extToId_);
+		if (numIds_ == 0)
+		{
+			writeExtBuff(plan,1,extToId_);
+			return true;
+		}
+
+		StdBuffPlan_t stdPlan;
+		cover(ids_,numIds_,BUFF_NUM_FILTERS[1],stdPlan.mask,stdPlan.filters,stdPlan.numFilters);
+		writeStdBuff(plan,1,stdPlan);
+		plan.stdAccepts = countAccepts(&stdPlan,1);
+		plan.stdFalseAccepts = plan.stdAccepts - numIds_;
+		return true;
+	}
+
+	// start with the groups that all 6 filters would use under one mask
+	uint16_t groupMask;
+	uint16_t groups[6];
+	uint8_t numGroups;
+	cover(ids_,numIds_,6,groupMask,groups,numGroups);
+
+	// try giving each combination of up to 2 groups to RXB0 (and the rest
+	// to RXB1), then re-cover each buffer's share with its own mask
+	StdBuffPlan_t bestPlans[2];
+	uint16_t bestAccepts = MEGA_CAN_NUM_STD_IDS + 1;
+	uint16_t split[MEGA_CAN_FILTER_PLAN_MAX_IDS];
+	for (uint8_t sel=0; sel<(1 << numGroups); sel++)
+	{
+		if (popCount(sel) > BUFF_NUM_FILTERS[0])
+		{
+			continue;
+		}
+
+		// RXB0's ids go at the front of split, RXB1's at the back
+		uint8_t numA = 0;
+		uint8_t idxB = numIds_;
+		for (uint8_t i=0; i<numIds_; i++)
+		{
+			bool inA = false;
+			for (uint8_t g=0; g<numGroups && ! inA; g++)
+			{
+				inA = (sel & (1 << g)) && (ids_[i] & groupMask) == groups[g];
+			}
+			if (inA)
+			{
+				split[numA++] = ids_[i];
+			}
+			else
+			{
+				split[--idxB] = ids_[i];
+			}
+		}
+
+		StdBuffPlan_t plans[2];
+		const uint16_t *buffIds[2] = {split, split + idxB};
+		const uint8_t buffNumIds[2] = {numA, (uint8_t)(numIds_ - idxB)};
+		for (uint8_t b=0; b<2; b++)
+		{
+			if (buffNumIds[b])
+			{
+				cover(buffIds[b],buffNumIds[b],BUFF_NUM_FILTERS[b],plans[b].mask,plans[b].filters,plans[b].numFilters);
+			}
+			else
+			{
+				// unneeded buffer exactly matches an id we want anyway
+				plans[b].mask = STD_ID_MASK;
+				plans[b].filters[0] = ids_[0];
+				plans[b].numFilters = 1;
+			}
+		}
+
+		const uint16_t accepts = countAccepts(plans,2);
+		if (accepts < bestAccepts)
+		{
+			bestAccepts = accepts;
+			memcpy(bestPlans,plans,sizeof(plans));
+		}
+	}
+
+	writeStdBuff(plan,0,bestPlans[0]);
+	writeStdBuff(plan,1,bestPlans[1]);
+	plan.stdAccepts = bestAccepts;
+	plan.stdFalseAccepts = bestAccepts - numIds_;
+	return true;
+}
+
+}// namespace - MegaCAN
@@ -0,0 +1,156 @@
+#ifndef MEGACAN_FILTER_PLANNER_H_
+#define MEGACAN_FILTER_PLANNER_H_
+
+#include <mcp_can/mcp_can.h>
+
+#include <stdint.h>
+
+namespace MegaCAN
+{
+
+// max number of 11bit identifiers a FilterPlanner can be asked to accept
+#define MEGA_CAN_FILTER_PLAN_MAX_IDS 64
+
+// number of distinct 11bit identifiers
+#define MEGA_CAN_NUM_STD_IDS 2048
+
+/**
+ * An assignment of the MCP2515's 2 masks and 6 filters. Mask 0 and filters
+ * 0-1 belong to RXB0; mask 1 and filters 2-5 belong to RXB1.
+ */
+struct FilterPlan_t
+{
+	// values are encoded the same as MCP_CAN::init_Mask()/init_Filt()
+	uint32_t masks[2];
+	uint32_t filters[6];
+
+	// bit N set if mask N uses the extended (29bit) encoding
+	uint8_t extMasks;
+
+	// bit N set if filter N matches extended frames (else standard frames)
+	uint8_t extFilters;
+
+	// number of 11bit identifiers that pass the filters
+	uint16_t stdAccepts;
+
+	// number of 11bit identifiers that pass the filters but weren't asked for
+	uint16_t stdFalseAccepts;
+
+	/**
+	 * @return
+	 * The fraction of unwanted 11bit identifiers that still pass the filters
+	 * (assuming unwanted traffic is spread evenly across the identifiers)
+	 */
+	float
+	falseAcceptRate() const
+	{
+		const uint16_t unwanted = MEGA_CAN_NUM_STD_IDS - (stdAccepts - stdFalseAccepts);
+		return (unwanted ? (float)(stdFalseAccepts) / unwanted : 0.0f);
+	}
+
+	/**
+	 * Loads the plan into the MCP2515 hardware filters.
+	 *
+	 * @return
+	 * The MCP_CAN result (MCP2515_OK on success)
+	 */
+	uint8_t
+	write(
+			MCP_CAN *can) const
+	{
+		return can->init_MaskFilt(masks,extMasks,filters,extFilters);
+	}
+};
+
+/**
+ * Computes an assignment of the MCP2515's masks and filters that accepts a
+ * set of 11bit identifiers (ie. Megasquirt realtime broadcast messages)
+ * and/or 29bit Megasquirt frames addressed to a device, while rejecting as
+ * much of the remaining traffic as possible in silicon.
+ *
+ * Each mask is shared by its buffer's filters, so a group of identifiers is
+ * covered by clearing mask bits (don't cares) until the group fits within
+ * the buffer's filters. Don't care bits are chosen greedily by how many
+ * filters they merge, and groups are split across RXB0 and RXB1 by trying
+ * each way of giving RXB0 up to 2 of the groups.
+ *
+ * Planning is done on the stack in O(n^2) time for n identifiers, so call
+ * plan() from the main loop rather than an ISR.
+ */
+class FilterPlanner
+{
+public:
+	FilterPlanner();
+
+	// forgets all identifiers and the extended toId
+	void
+	clear();
+
+	/**
+	 * @param[in] id
+	 * An 11bit identifier that must be accepted
+	 *
+	 * @return
+	 * False if the identifier is invalid or the planner is full
+	 */
+	bool
+	acceptStd(
+			const uint16_t id);
+
+	/**
+	 * @param[in] first
+	 * The first 11bit identifier in the range
+	 *
+	 * @param[in] last
+	 * The last 11bit identifier in the range (inclusive)
+	 *
+	 * @return
+	 * False if the range is invalid or the planner is full (identifiers
+	 * that fit are still accepted)
+	 */
+	bool
+	acceptStdRange(
+			const uint16_t first,
+			const uint16_t last);
+
+	/**
+	 * Accept 29bit Megasquirt frames addressed to a device. These are
+	 * filtered on the 4bit toId field of the header only.
+	 *
+	 * @param[in] toId
+	 * The Megasquirt CAN ID of the device (ie. its myId)
+	 */
+	void
+	acceptExtToId(
+			const uint8_t toId);
+
+	uint8_t
+	numStdIds() const
+	{
+		return numIds_;
+	}
+
+	/**
+	 * @param[out] plan
+	 * The resulting mask and filter assignment
+	 *
+	 * @return
+	 * False if nothing has been accepted (there's nothing to plan)
+	 */
+	bool
+	plan(
+			FilterPlan_t &plan) const;
+
+private:
+	// sorted, unique 11bit identifiers to accept
+	uint16_t ids_[MEGA_CAN_FILTER_PLAN_MAX_IDS];
+	uint8_t numIds_;
+
+	bool extEnabled_;
+	uint8_t extToId_;
+
+};
+
+}// namespace - MegaCAN
+
+#endif
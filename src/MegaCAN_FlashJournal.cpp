@@ -0,0 +1,337 @@
+#include "MegaCAN_FlashJournal.h"
+
+#include "CrcUtils.h"
+#include "logging.h"
+
+#include <avr/eeprom.h>
+#include <avr/wdt.h>
+#include <string.h>
+
+namespace MegaCAN
+{
+
+// the journal that FlashUtils reads are mapped through
+static FlashJournal *mappedJournal = nullptr;
+
+static
+fsize_t
+mapAddress(
+		const fsize_t offset)
+{
+	return mappedJournal->translate(offset);
+}
+
+static
+void
+writeMapped(
+		const fsize_t offset,
+		const uint8_t value)
+{
+	mappedJournal->write(offset,value);
+}
+
+FlashJournal::FlashJournal(
+		fsize_t homeOffset,
+		uint8_t numChunks,
+		uint8_t *chunkMap,
+		fsize_t journalOffset,
+		uint8_t numSlots)
+ : homeOffset_(homeOffset)
+ , numChunks_(chunkMap ? numChunks : 0)
+ , chunkMap_(chunkMap)
+ , journalOffset_(journalOffset)
+ , numSlots_(numSlots < MEGA_CAN_JOURNAL_NO_SLOT ? numSlots : MEGA_CAN_JOURNAL_NO_SLOT - 1)
+ , compactedSeq_(0)
+ , nextSlot_(0)
+ , compactionCount_(0)
+ , stagedIdx_(MEGA_CAN_JOURNAL_RECORD_SIZE + 1)
+ , compacting_(false)
+ , compactPos_(0)
+{
+	if (chunkMap_)
+	{
+		memset(chunkMap_,MEGA_CAN_JOURNAL_NO_SLOT,numChunks_);
+	}
+}
+
+void
+FlashJournal::begin()
+{
+	// use the newest valid copy of the header
+	uint16_t seqA = 0;
+	uint16_t seqB = 0;
+	const bool validA = readHeader(journalOffset_,seqA);
+	const bool validB = readHeader(journalOffset_ + MEGA_CAN_JOURNAL_HEADER_SIZE / 2,seqB);
+	if (validA && validB)
+	{
+		compactedSeq_ = ((int16_t)(seqA - seqB) >= 0 ? seqA : seqB);
+	}
+	else if (validA || validB)
+	{
+		compactedSeq_ = (validA ? seqA : seqB);
+	}
+	else
+	{
+		WARN("no valid journal header. assuming empty journal");
+		compactedSeq_ = 0;
+	}
+
+	// replay records until the first invalid one
+	memset(chunkMap_,MEGA_CAN_JOURNAL_NO_SLOT,numChunks_);
+	nextSlot_ = 0;
+	uint8_t rec[MEGA_CAN_JOURNAL_RECORD_SIZE];
+	while (nextSlot_ < numSlots_)
+	{
+		eeprom_read_block(rec,(const void *)(slotAddr(nextSlot_)),MEGA_CAN_JOURNAL_RECORD_SIZE);
+		const uint16_t seq = ((uint16_t)(rec[0]) << 8) | rec[1];
+		if (seq != (uint16_t)(compactedSeq_ + 1 + nextSlot_) ||
+			rec[2] >= numChunks_ ||
+			rec[MEGA_CAN_JOURNAL_RECORD_SIZE - 1] != CrcUtils::crc8(rec,MEGA_CAN_JOURNAL_RECORD_SIZE - 1))
+		{
+			break;
+		}
+		chunkMap_[rec[2]] = nextSlot_;
+		nextSlot_++;
+	}
+	INFO(
+		"journal - compactedSeq: %u; records: %d/%d",
+		compactedSeq_,
+		nextSlot_,
+		numSlots_);
+
+	mappedJournal = this;
+	FlashUtils::setAddressMapper(mapAddress);
+	FlashUtils::setByteWriter(writeMapped);
+}
+
+fsize_t
+FlashJournal::translate(
+		const fsize_t offset) const
+{
+	if ( ! covers(offset))
+	{
+		return offset;
+	}
+
+	const uint8_t slot = chunkMap_[chunkOf(offset)];
+	if (slot == MEGA_CAN_JOURNAL_NO_SLOT)
+	{
+		return offset;
+	}
+	return slotAddr(slot) + 3 + ((offset - homeOffset_) % MEGA_CAN_JOURNAL_CHUNK_SIZE);
+}
+
+void
+FlashJournal::compact()
+{
+	startCompaction();
+	while (compactStep())
+	{
+		// writing to EEPROM is slow (~3.4ms per byte)
+		// keep watchdog happy if user code uses it
+		wdt_reset();
+	}
+}
+
+void
+FlashJournal::startCompaction()
+{
+	INFO("compacting journal (%d records)", nextSlot_);
+	compacting_ = true;
+	compactPos_ = 0;
+}
+
+bool
+FlashJournal::compactStep()
+{
+	if ( ! compacting_)
+	{
+		return false;
+	}
+
+	// copy the latest version of each chunk home. a chunk stays mapped to
+	// its record until its last byte is copied, so reads never see a
+	// partially copied chunk.
+	const uint16_t homeSize = numChunks_ * MEGA_CAN_JOURNAL_CHUNK_SIZE;
+	while (compactPos_ < homeSize)
+	{
+		const uint8_t c = compactPos_ / MEGA_CAN_JOURNAL_CHUNK_SIZE;
+		const uint8_t i = compactPos_ % MEGA_CAN_JOURNAL_CHUNK_SIZE;
+		if (chunkMap_[c] == MEGA_CAN_JOURNAL_NO_SLOT)
+		{
+			compactPos_ += MEGA_CAN_JOURNAL_CHUNK_SIZE - i;
+			continue;
+		}
+
+		uint8_t *dst = (uint8_t *)(homeOffset_ + compactPos_);
+		const uint8_t value = eeprom_read_byte((const uint8_t *)(slotAddr(chunkMap_[c]) + 3 + i));
+		compactPos_++;
+		if (i == MEGA_CAN_JOURNAL_CHUNK_SIZE - 1)
+		{
+			chunkMap_[c] = MEGA_CAN_JOURNAL_NO_SLOT;
+		}
+		if (eeprom_read_byte(dst) != value)
+		{
+			eeprom_write_byte(dst,value);
+			return true;
+		}
+	}
+
+	// invalidate every record by writing both copies of the header. if
+	// power is lost part way through, the records are simply replayed (and
+	// compacted) again
+	const uint16_t seq = compactedSeq_ + nextSlot_;
+	uint8_t hdr[MEGA_CAN_JOURNAL_HEADER_SIZE / 2];
+	hdr[0] = seq >> 8;
+	hdr[1] = seq & 0xff;
+	hdr[2] = CrcUtils::crc8(hdr,2);
+	while (compactPos_ < homeSize + MEGA_CAN_JOURNAL_HEADER_SIZE)
+	{
+		const uint8_t h = compactPos_ - homeSize;
+		uint8_t *dst = (uint8_t *)(journalOffset_ + h);
+		const uint8_t value = hdr[h % sizeof(hdr)];
+		compactPos_++;
+		if (eeprom_read_byte(dst) != value)
+		{
+			eeprom_write_byte(dst,value);
+			return true;
+		}
+	}
+
+	compactedSeq_ = seq;
+	nextSlot_ = 0;
+	compactionCount_++;
+	compacting_ = false;
+	return false;
+}
+
+void
+FlashJournal::write(
+		const fsize_t offset,
+		const uint8_t value)
+{
+	if ( ! covers(offset))
+	{
+		eeprom_update_byte((uint8_t *)(offset),value);
+		return;
+	}
+
+	// the burn engine's interrupt is held off, so finish its work here
+	while (compactStep() || writeStaged())
+	{
+		wdt_reset();
+	}
+
+	const uint8_t chunk = chunkOf(offset);
+	if (chunkMap_[chunk] != MEGA_CAN_JOURNAL_NO_SLOT && freeSlots() == 0)
+	{
+		compact();
+	}
+
+	if (chunkMap_[chunk] == MEGA_CAN_JOURNAL_NO_SLOT)
+	{
+		// the home location is current (and no record will replace it)
+		eeprom_update_byte((uint8_t *)(offset),value);
+		return;
+	}
+
+	// append a new version of the chunk
+	const fsize_t chunkOffset = homeOffset_ + chunk * MEGA_CAN_JOURNAL_CHUNK_SIZE;
+	uint8_t data[MEGA_CAN_JOURNAL_CHUNK_SIZE];
+	for (uint8_t i=0; i<MEGA_CAN_JOURNAL_CHUNK_SIZE; i++)
+	{
+		data[i] = readRaw(chunkOffset + i);
+	}
+	data[offset - chunkOffset] = value;
+	if (stage(chunk,data))
+	{
+		while (writeStaged())
+		{
+			wdt_reset();
+		}
+	}
+}
+
+bool
+FlashJournal::stage(
+		const uint8_t chunk,
+		const uint8_t *data)
+{
+	if (nextSlot_ >= numSlots_)
+	{
+		return false;
+	}
+
+	// don't spend a record on a chunk that hasn't changed
+	const fsize_t offset = homeOffset_ + chunk * MEGA_CAN_JOURNAL_CHUNK_SIZE;
+	bool changed = false;
+	for (uint8_t i=0; i<MEGA_CAN_JOURNAL_CHUNK_SIZE && ! changed; i++)
+	{
+		changed = readRaw(offset + i) != data[i];
+	}
+	if ( ! changed)
+	{
+		return false;
+	}
+
+	const uint16_t seq = compactedSeq_ + 1 + nextSlot_;
+	staged_[0] = seq >> 8;
+	staged_[1] = seq & 0xff;
+	staged_[2] = chunk;
+	memcpy(staged_ + 3,data,MEGA_CAN_JOURNAL_CHUNK_SIZE);
+	staged_[MEGA_CAN_JOURNAL_RECORD_SIZE - 1] = CrcUtils::crc8(staged_,MEGA_CAN_JOURNAL_RECORD_SIZE - 1);
+	stagedIdx_ = 0;
+	return true;
+}
+
+bool
+FlashJournal::writeStaged()
+{
+	// the seq goes last (after the crc) and commits the record. until then
+	// the slot holds an older pass's seq, so a torn record is never
+	// mistaken as valid.
+	const fsize_t addr = slotAddr(nextSlot_);
+	while (stagedIdx_ < MEGA_CAN_JOURNAL_RECORD_SIZE)
+	{
+		const uint8_t i = (stagedIdx_++ + 2) % MEGA_CAN_JOURNAL_RECORD_SIZE;
+		uint8_t *dst = (uint8_t *)(addr + i);
+		if (eeprom_read_byte(dst) != staged_[i])
+		{
+			eeprom_write_byte(dst,staged_[i]);
+			return true;
+		}
+	}
+
+	if (stagedIdx_ == MEGA_CAN_JOURNAL_RECORD_SIZE)
+	{
+		// record is complete. point the chunk at it
+		chunkMap_[staged_[2]] = nextSlot_;
+		nextSlot_++;
+		stagedIdx_++;
+	}
+	return false;
+}
+
+uint8_t
+FlashJournal::readRaw(
+		const fsize_t offset) const
+{
+	return eeprom_read_byte((const uint8_t *)(translate(offset)));
+}
+
+bool
+FlashJournal::readHeader(
+		const fsize_t addr,
+		uint16_t &seq) const
+{
+	uint8_t hdr[MEGA_CAN_JOURNAL_HEADER_SIZE / 2];
+	eeprom_read_block(hdr,(const void *)(addr),sizeof(hdr));
+	if (hdr[2] != CrcUtils::crc8(hdr,2))
+	{
+		return false;
+	}
+	seq = ((uint16_t)(hdr[0]) << 8) | hdr[1];
+	return true;
+}
+
+}// namespace - MegaCAN
@@ -0,0 +1,277 @@
+#ifndef MEGACAN_FLASH_JOURNAL_H_
+#define MEGACAN_FLASH_JOURNAL_H_
+
+#include <stdint.h>
+
+#include "FlashUtils.h"
+
+namespace MegaCAN
+{
+
+// the number of bytes of table data carried by each journal record
+#define MEGA_CAN_JOURNAL_CHUNK_SIZE 8
+
+// seq (2 bytes), chunk (1 byte), data, crc8 (1 byte)
+#define MEGA_CAN_JOURNAL_RECORD_SIZE (MEGA_CAN_JOURNAL_CHUNK_SIZE + 4)
+
+// two copies of the compacted sequence number (2 bytes) and its crc8
+#define MEGA_CAN_JOURNAL_HEADER_SIZE 6
+
+// chunk map value used for chunks that live at their home location
+#define MEGA_CAN_JOURNAL_NO_SLOT 0xFF
+
+// the number of EEPROM bytes needed for a journal with N record slots
+#define MEGA_CAN_JOURNAL_SIZE(N) (MEGA_CAN_JOURNAL_HEADER_SIZE + (N) * MEGA_CAN_JOURNAL_RECORD_SIZE)
+
+/**
+ * Append-only, wear-leveled storage for flash tables.
+ *
+ * The "home" region of EEPROM (where the flash tables normally live) is
+ * split into 8 byte chunks. Rather than rewriting modified bytes in place,
+ * modified chunks are appended to a separate journal region as records:
+ *
+ *   [seq (big endian)] [chunk] [8 data bytes] [crc8]
+ *
+ * Records are written to slots 0,1,2... in order, and the record in slot i
+ * is only valid if its crc8 matches and its seq is (compactedSeq + 1 + i).
+ * The seq is written last, after the crc8, so it acts as the record's
+ * commit: a torn record still holds the seq of an older pass over the
+ * journal and is never mistaken as valid. The chunk map can then be
+ * rebuilt at boot by scanning the slots until the first invalid one.
+ *
+ * Once the journal fills up, it's compacted by copying the latest version
+ * of each journaled chunk home and then bumping compactedSeq (which
+ * invalidates every record in one small header write). Compaction is done
+ * a byte at a time (see compactStep()) so that it can be driven by the
+ * EEPROM ready interrupt like appends are.
+ *
+ * All FlashUtils reads are redirected to the latest copy of each byte
+ * through FlashUtils::setAddressMapper(), and FlashUtils writes go through
+ * write() (see FlashUtils::setByteWriter()).
+ */
+class FlashJournal
+{
+public:
+	/**
+	 * @param[in] homeOffset
+	 * EEPROM offset of the first chunk that can be journaled
+	 *
+	 * @param[in] numChunks
+	 * The number of 8 byte chunks that can be journaled
+	 *
+	 * @param[in] chunkMap
+	 * User provided storage for the chunk map (numChunks entries)
+	 *
+	 * @param[in] journalOffset
+	 * EEPROM offset of the journal region. The region must be
+	 * MEGA_CAN_JOURNAL_SIZE(numSlots) bytes and can't overlap the home
+	 * region.
+	 *
+	 * @param[in] numSlots
+	 * The number of record slots in the journal (max of 254)
+	 */
+	FlashJournal(
+			fsize_t homeOffset,
+			uint8_t numChunks,
+			uint8_t *chunkMap,
+			fsize_t journalOffset,
+			uint8_t numSlots);
+
+	/**
+	 * Rebuilds the chunk map from the journal and installs the FlashUtils
+	 * address mapper. Call once at startup before reading any tables.
+	 */
+	void
+	begin();
+
+	/**
+	 * @return
+	 * The EEPROM address that currently holds the byte at flash offset
+	 */
+	fsize_t
+	translate(
+			const fsize_t offset) const;
+
+	fsize_t
+	homeOffset() const
+	{
+		return homeOffset_;
+	}
+
+	/**
+	 * @return
+	 * True if the flash offset is within the journaled home region
+	 */
+	bool
+	covers(
+			const fsize_t offset) const
+	{
+		return offset >= homeOffset_ &&
+			(offset - homeOffset_) < (numChunks_ * MEGA_CAN_JOURNAL_CHUNK_SIZE);
+	}
+
+	/**
+	 * @return
+	 * The chunk index that holds the flash offset (offset must be covered)
+	 */
+	uint8_t
+	chunkOf(
+			const fsize_t offset) const
+	{
+		return (offset - homeOffset_) / MEGA_CAN_JOURNAL_CHUNK_SIZE;
+	}
+
+	uint8_t
+	freeSlots() const
+	{
+		return numSlots_ - nextSlot_;
+	}
+
+	uint8_t
+	numSlots() const
+	{
+		return numSlots_;
+	}
+
+	// number of times the journal has been compacted since boot
+	uint16_t
+	compactionCount() const
+	{
+		return compactionCount_;
+	}
+
+	/**
+	 * Copies the latest version of each journaled chunk home and empties
+	 * the journal. This is synchronous (~3.4ms per changed byte) and must
+	 * not be called while a record is staged. The burn engine uses
+	 * startCompaction() and compactStep() instead.
+	 */
+	void
+	compact();
+
+	/**
+	 * Starts an incremental compaction. Must not be called while a record
+	 * is staged.
+	 */
+	void
+	startCompaction();
+
+	/**
+	 * Starts the next EEPROM write of an in-progress compaction. The
+	 * EEPROM must be ready.
+	 *
+	 * @return
+	 * True if an EEPROM write was started, false once the compaction has
+	 * completed (or if none was started).
+	 */
+	bool
+	compactStep();
+
+	bool
+	compacting() const
+	{
+		return compacting_;
+	}
+
+	/**
+	 * Synchronously and durably writes a byte of flash. A byte in a
+	 * journaled chunk is written as a new record for the chunk, so the
+	 * write survives a reboot (rather than being hidden by the record).
+	 * Finishes any record or compaction the burn engine left part way, so
+	 * it must be called with the EEPROM ready interrupt held off (as
+	 * FlashUtils::writeByte() does).
+	 *
+	 * @param[in] offset
+	 * The flash byte offset to write to
+	 *
+	 * @param[in] value
+	 * The value to write
+	 */
+	void
+	write(
+			const fsize_t offset,
+			const uint8_t value);
+
+	/**
+	 * Builds a record for a chunk. The record is written by subsequent
+	 * calls to writeStaged().
+	 *
+	 * @param[in] chunk
+	 * The chunk index to append
+	 *
+	 * @param[in] data
+	 * The chunk's new contents (8 bytes)
+	 *
+	 * @return
+	 * True if the record was staged, false if the journal is full or the
+	 * chunk's contents are unchanged (nothing to write).
+	 */
+	bool
+	stage(
+			const uint8_t chunk,
+			const uint8_t *data);
+
+	/**
+	 * Starts writing the next byte of the staged record (bytes that already
+	 * match the EEPROM are skipped). The seq is written last. Once the whole
+	 * record is written the chunk map is updated to point at it. The EEPROM
+	 * must be ready.
+	 *
+	 * @return
+	 * True if an EEPROM write was started, false once the staged record
+	 * has been committed (or if nothing was staged).
+	 */
+	bool
+	writeStaged();
+
+	/**
+	 * Reads the current contents of a flash offset without holding off the
+	 * EEPROM ready interrupt (for use from within the burn engine).
+	 */
+	uint8_t
+	readRaw(
+			const fsize_t offset) const;
+
+private:
+	fsize_t
+	slotAddr(
+			const uint8_t slot) const
+	{
+		return journalOffset_ + MEGA_CAN_JOURNAL_HEADER_SIZE + slot * MEGA_CAN_JOURNAL_RECORD_SIZE;
+	}
+
+	// reads the compacted sequence number from the header (false if corrupt)
+	bool
+	readHeader(
+			const fsize_t addr,
+			uint16_t &seq) const;
+
+private:
+	fsize_t homeOffset_;
+	uint8_t numChunks_;
+	// slot holding the latest copy of each chunk (or MEGA_CAN_JOURNAL_NO_SLOT)
+	uint8_t *chunkMap_;
+
+	fsize_t journalOffset_;
+	uint8_t numSlots_;
+
+	// sequence number of the last record that was compacted
+	uint16_t compactedSeq_;
+	// slot the next record will be written to
+	uint8_t nextSlot_;
+	uint16_t compactionCount_;
+
+	// record that's being written by writeStaged()
+	uint8_t staged_[MEGA_CAN_JOURNAL_RECORD_SIZE];
+	// number of staged_ bytes written (> record size when nothing is staged)
+	uint8_t stagedIdx_;
+
+	// next byte of the home region (then header) that compactStep() copies
+	bool compacting_;
+	uint16_t compactPos_;
+
+};
+
+}// namespace - MegaCAN
+
+#endif
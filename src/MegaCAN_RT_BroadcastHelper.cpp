@@ -18,6 +18,8 @@ RT_BroadcastHelper::RT_BroadcastHelper()
  , ts_(nullptr)
  , task_(nullptr)
  , prevRate_(-1)
+ , divisor_(1)
+ , skipCount_(0)
 {
 }
 
@@ -37,7 +39,7 @@ void
 RT_BroadcastHelper::execute()
 {
 	RT_Broadcast_T::Control_T ctrl;
-	ctrl.value = EEPROM.read(RT_BCAST_OFFSET_ + offsetof(RT_Broadcast_T, ctrl));
+	ctrl.value = FlashUtils::readByte(RT_BCAST_OFFSET_ + offsetof(RT_Broadcast_T, ctrl));
 
 	if (ctrl.bits.rate != prevRate_)
 	{
@@ -76,10 +78,15 @@ RT_BroadcastHelper::execute()
 void
 RT_BroadcastHelper::doBroadcast()
 {
-	if ( ! callback_)
+	if ( ! callback_ || divisor_ == 0)
 	{
 		return;
 	}
+	else if (++skipCount_ < divisor_)
+	{
+		return;
+	}
+	skipCount_ = 0;
 
 	uint16_t baseId = EEPROM_GetBigU16(RT_BCAST_OFFSET_ + offsetof(RT_Broadcast_T, baseId));
 
@@ -88,7 +95,7 @@ RT_BroadcastHelper::doBroadcast()
 	uint8_t groupMask = 0;
 	for (uint8_t g=0; g<NUM_RT_BCAST_GROUP_MASKS; g++)
 	{
-		groupMask = EEPROM.read(groupMaskAddr++);
+		groupMask = FlashUtils::readByte(groupMaskAddr++);
 		for (uint8_t gg=0; gg<8; gg++)
 		{
 			if (groupMask & (1<<gg))
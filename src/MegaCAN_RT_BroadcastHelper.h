@@ -53,6 +53,20 @@ public:
 	void
 	doBroadcast();
 
+	/**
+	 * Scales down broadcasting without changing the configured rate (ie. from
+	 * Device::optionalTxDivisor() while the CAN bus is in trouble).
+	 *
+	 * @param[in] divisor
+	 * 1 to send every broadcast, N to send every Nth, or 0 to send none
+	 */
+	void
+	setRateDivisor(
+		uint8_t divisor)
+	{
+		divisor_ = divisor;
+	}
+
 private:
 	// flash offset where user maintains a RT_Broadcast_T structure
 	uint16_t RT_BCAST_OFFSET_;
@@ -68,6 +82,11 @@ private:
 
 	uint8_t prevRate_;
 
+	// only every Nth broadcast is sent (none if 0)
+	uint8_t divisor_;
+	// broadcasts skipped since the last one that was sent
+	uint8_t skipCount_;
+
 };
 
 extern RT_BroadcastHelper RT_Bcast;
@@ -0,0 +1,445 @@
+#include "MegaCAN_RealtimeDataListener.h"
+
+#include <stddef.h>
+
+namespace MegaCAN
+{
+
+int32_t
+RT_Signal::decode(
+		const uint8_t *msgData) const
+{
+	uint32_t raw = 0;
+	for (uint8_t b=0; b<size; b++)
+	{
+		raw = (raw << 8) | msgData[offset + b];
+	}
+
+	if (isSigned && size < 4 && (raw & (1ul << (size * 8 - 1))))
+	{
+		// sign extend
+		raw |= ~0ul << (size * 8);
+	}
+	return (int32_t)(raw);
+}
+
+// destination of each realtime message within RT_Data, indexed by message number
+static constexpr size_t RT_MSG_OFFSETS[] = {
+	offsetof(RT_Data,m0),
+	offsetof(RT_Data,m1),
+	offsetof(RT_Data,m2),
+	offsetof(RT_Data,m3),
+	offsetof(RT_Data,m4),
+	offsetof(RT_Data,m5),
+	offsetof(RT_Data,m6),
+	offsetof(RT_Data,m7),
+	offsetof(RT_Data,m8),
+	offsetof(RT_Data,m9),
+	offsetof(RT_Data,m10),
+	offsetof(RT_Data,m11),
+	offsetof(RT_Data,m12),
+	offsetof(RT_Data,m13),
+	offsetof(RT_Data,m14),
+	offsetof(RT_Data,m15),
+	offsetof(RT_Data,m16),
+	offsetof(RT_Data,m17),
+	offsetof(RT_Data,m18),
+	offsetof(RT_Data,m19),
+	offsetof(RT_Data,m20),
+	offsetof(RT_Data,m21),
+	offsetof(RT_Data,m22),
+	offsetof(RT_Data,m23),
+	offsetof(RT_Data,m24),
+	offsetof(RT_Data,m25),
+	offsetof(RT_Data,m26),
+	offsetof(RT_Data,m27),
+	offsetof(RT_Data,m28),
+	offsetof(RT_Data,m29),
+	offsetof(RT_Data,m30),
+	offsetof(RT_Data,m31),
+	offsetof(RT_Data,m32),
+	offsetof(RT_Data,m33),
+	offsetof(RT_Data,m34),
+	offsetof(RT_Data,m35),
+	offsetof(RT_Data,m36),
+	offsetof(RT_Data,m37),
+	offsetof(RT_Data,m38),
+	offsetof(RT_Data,m39),
+	offsetof(RT_Data,m40),
+	offsetof(RT_Data,m41),
+	offsetof(RT_Data,m42),
+	offsetof(RT_Data,m43),
+	offsetof(RT_Data,m44),
+	offsetof(RT_Data,m45),
+	offsetof(RT_Data,m46),
+	offsetof(RT_Data,m47),
+	offsetof(RT_Data,m48),
+	offsetof(RT_Data,m49),
+	offsetof(RT_Data,m50),
+	offsetof(RT_Data,m51),
+	offsetof(RT_Data,m52),
+	offsetof(RT_Data,m53),
+	offsetof(RT_Data,m54),
+	offsetof(RT_Data,m55),
+	offsetof(RT_Data,m56),
+	offsetof(RT_Data,m57),
+	offsetof(RT_Data,m58),
+	offsetof(RT_Data,m59),
+	offsetof(RT_Data,m60),
+	offsetof(RT_Data,m61),
+	offsetof(RT_Data,m62)
+};
+
+static_assert(sizeof(RT_MSG_OFFSETS) / sizeof(RT_MSG_OFFSETS[0]) == MEGA_CAN_RT_NUM_MSGS,
+		"RT_MSG_OFFSETS must have an entry for every realtime message");
+static_assert(sizeof(RT_Data) == MEGA_CAN_RT_NUM_MSGS * MEGA_CAN_RT_MSG_SIZE,
+		"RT_Data must not contain padding");
+
+static constexpr bool
+offsetsAreContiguous(
+		const uint8_t msgNum)
+{
+	return msgNum >= MEGA_CAN_RT_NUM_MSGS ||
+		(RT_MSG_OFFSETS[msgNum] == msgNum * MEGA_CAN_RT_MSG_SIZE &&
+		 offsetsAreContiguous(msgNum + 1));
+}
+
+// lets handleStandard() compute the destination rather than switch on it
+static_assert(offsetsAreContiguous(0),
+		"realtime message N must be stored at offset N * MEGA_CAN_RT_MSG_SIZE within RT_Data");
+
+RealtimeDataListener::RealtimeDataListener(
+		uint8_t cs,
+		uint8_t myId,
+		uint8_t intPin,
+		CAN_Msg *buff,
+		uint8_t buffSize,
+		uint16_t baseId)
+ : RealtimeListenerBase(cs,myId,intPin,buff,buffSize,baseId)
+ , numWatches_(0)
+#if MEGA_CAN_RX_TIMESTAMPS
+ , timeoutMs_(MEGA_CAN_RT_DEFAULT_TIMEOUT_MS)
+ , lastSweep_(0)
+ , numArrivals_(0)
+#endif
+{
+	memset(&data_,0,sizeof(data_));
+	memset((void*)(seq_),0,sizeof(seq_));
+	memset((void*)(dirty_),0,sizeof(dirty_));
+	memset((void*)(changed_),0,sizeof(changed_));
+	memset((void*)(received_),0,sizeof(received_));
+#if MEGA_CAN_RX_TIMESTAMPS
+	memset((void*)(rxTimes_),0,sizeof(rxTimes_));
+	memset((void*)(fresh_),0,sizeof(fresh_));
+	memset((void*)(tracked_),0,sizeof(tracked_));
+#endif
+}
+
+bool
+RealtimeDataListener::planFilters(
+		FilterPlan_t &plan) const
+{
+	const uint16_t first = baseId();
+	FilterPlanner planner;
+	return planner.acceptStdRange(first,first + MEGA_CAN_RT_NUM_MSGS - 1) &&
+		planner.plan(plan);
+}
+
+void
+RealtimeDataListener::handleStandard(
+		const uint32_t id,
+		const uint8_t length,
+		uint8_t *data)
+{
+	const uint8_t msgNum = msgNumOf(id);
+	if (msgNum < MEGA_CAN_RT_NUM_MSGS)
+	{
+		const uint8_t idx = msgNum >> 3;
+		const uint8_t bit = 1 << (msgNum & 0x7);
+		uint8_t *slot = reinterpret_cast<uint8_t *>(&data_) + msgNum * MEGA_CAN_RT_MSG_SIZE;
+
+		// only frames that change a message are flagged for the application
+		if (updateSlot(slot,seq_[msgNum],length,data,(received_[idx] & bit) == 0))
+		{
+			received_[idx] |= bit;
+			dirty_[idx] |= bit;
+			changed_[idx] |= bit;
+		}
+
+#if MEGA_CAN_RX_TIMESTAMPS
+		const uint32_t stamp = rxTimestamp();
+		if ((tracked_[idx] & bit) && (fresh_[idx] & bit))
+		{
+			updateArrivals(msgNum,stamp - rxTimes_[msgNum]);
+		}
+		rxTimes_[msgNum] = stamp;
+		fresh_[idx] |= bit;
+#endif
+	}
+}
+
+void
+RealtimeDataListener::snapshot(
+		RT_Data &out,
+		const uint8_t first,
+		const uint8_t count) const
+{
+	uint8_t *dst = reinterpret_cast<uint8_t *>(&out) + first * MEGA_CAN_RT_MSG_SIZE;
+	for (uint8_t msgNum=first; msgNum<MEGA_CAN_RT_NUM_MSGS && msgNum<(first + count); msgNum++)
+	{
+		copyMsg(msgNum,dst);
+		dst += MEGA_CAN_RT_MSG_SIZE;
+	}
+}
+
+bool
+RealtimeDataListener::takeDirty(
+		const uint8_t msgNum)
+{
+	if (msgNum >= MEGA_CAN_RT_NUM_MSGS)
+	{
+		return false;
+	}
+
+	const uint8_t idx = msgNum >> 3;
+	const uint8_t bit = 1 << (msgNum & 0x7);
+	bool dirty;
+	MC_ATOMIC_START
+	dirty = dirty_[idx] & bit;
+	dirty_[idx] &= ~bit;
+	MC_ATOMIC_END
+	return dirty;
+}
+
+bool
+RealtimeDataListener::watchSignal(
+		const RT_Signal &sig,
+		const uint32_t deadband,
+		RT_SignalCallback callback,
+		void *arg)
+{
+	if (sig.msgNum >= MEGA_CAN_RT_NUM_MSGS ||
+		(sig.size != 1 && sig.size != 2 && sig.size != 4) ||
+		(sig.offset + sig.size) > MEGA_CAN_RT_MSG_SIZE ||
+		callback == nullptr)
+	{
+		WARN("invalid signal in msg %d", sig.msgNum);
+		return false;
+	}
+	else if (numWatches_ >= MEGA_CAN_RT_MAX_WATCHES)
+	{
+		WARN("can't watch signal in msg %d. all watches are in use", sig.msgNum);
+		return false;
+	}
+
+	SignalWatch &watch = watches_[numWatches_++];
+	watch.sig = sig;
+	watch.deadband = deadband;
+	watch.callback = callback;
+	watch.arg = arg;
+	watch.lastValue = 0;
+	watch.reported = false;
+
+	// report the current value even if the message doesn't change again
+	MC_ATOMIC_START
+	changed_[sig.msgNum >> 3] |= 1 << (sig.msgNum & 0x7);
+	MC_ATOMIC_END
+	return true;
+}
+
+void
+RealtimeDataListener::copyMsg(
+		const uint8_t msgNum,
+		uint8_t *dst) const
+{
+	copySlot(
+		dst,
+		reinterpret_cast<const uint8_t *>(&data_) + msgNum * MEGA_CAN_RT_MSG_SIZE,
+		seq_[msgNum]);
+}
+
+void
+RealtimeDataListener::notifyWatches()
+{
+	if (numWatches_ == 0)
+	{
+		return;
+	}
+
+	uint8_t changed[sizeof(changed_)];
+	MC_ATOMIC_START
+	memcpy(changed,(const void*)(changed_),sizeof(changed));
+	memset((void*)(changed_),0,sizeof(changed_));
+	MC_ATOMIC_END
+
+	for (uint8_t w=0; w<numWatches_; w++)
+	{
+		SignalWatch &watch = watches_[w];
+		const uint8_t msgNum = watch.sig.msgNum;
+		if ((changed[msgNum >> 3] & (1 << (msgNum & 0x7))) == 0)
+		{
+			continue;
+		}
+
+		uint8_t msg[MEGA_CAN_RT_MSG_SIZE];
+		copyMsg(msgNum,msg);
+		const int32_t value = watch.sig.decode(msg);
+		// the difference of two 32bit values can overflow an int32_t, but its
+		// magnitude always fits a uint32_t when the larger one goes first
+		// (4 byte unsigned signals decode as their raw bits)
+		const bool rose = (watch.sig.isSigned ?
+			value > watch.lastValue :
+			(uint32_t)(value) > (uint32_t)(watch.lastValue));
+		const uint32_t mag = (rose ?
+			(uint32_t)(value) - (uint32_t)(watch.lastValue) :
+			(uint32_t)(watch.lastValue) - (uint32_t)(value));
+		if ( ! watch.reported || mag > watch.deadband)
+		{
+			watch.lastValue = value;
+			watch.reported = true;
+			watch.callback(watch.sig,value,watch.arg);
+		}
+	}
+}
+
+void
+RealtimeDataListener::handleDeferred()
+{
+	notifyWatches();
+
+#if MEGA_CAN_RX_TIMESTAMPS
+	// a sweep a millisecond is plenty for timeouts given in ms
+	const uint32_t now = MEGA_CAN_TIMESTAMP();
+	if ((now - lastSweep_) < 1000)
+	{
+		return;
+	}
+	lastSweep_ = now;
+	const uint32_t timeoutUs = (uint32_t)(timeoutMs_) * 1000;
+
+	for (uint8_t msgNum=0; msgNum<MEGA_CAN_RT_NUM_MSGS; msgNum++)
+	{
+		const uint8_t idx = msgNum >> 3;
+		const uint8_t bit = 1 << (msgNum & 0x7);
+		if ((fresh_[idx] & bit) == 0)
+		{
+			continue;
+		}
+
+		// ISR may be refreshing the message while we check it
+		MC_ATOMIC_START
+		if ((now - rxTimes_[msgNum]) > timeoutUs)
+		{
+			fresh_[idx] &= ~bit;
+		}
+		MC_ATOMIC_END
+	}
+#endif
+}
+
+#if MEGA_CAN_RX_TIMESTAMPS
+uint16_t
+RealtimeDataListener::age(
+		const uint8_t msgNum) const
+{
+	if ( ! isFresh(msgNum))
+	{
+		// the timestamp can wrap once a message goes stale
+		return MEGA_CAN_RT_AGE_UNKNOWN;
+	}
+
+	uint32_t rxTime;
+	MC_ATOMIC_START
+	rxTime = rxTimes_[msgNum];
+	MC_ATOMIC_END
+	return (MEGA_CAN_TIMESTAMP() - rxTime) / 1000;
+}
+
+bool
+RealtimeDataListener::trackArrivals(
+		const uint8_t msgNum)
+{
+	if (msgNum >= MEGA_CAN_RT_NUM_MSGS)
+	{
+		WARN("invalid realtime message %d", msgNum);
+		return false;
+	}
+
+	const uint8_t idx = msgNum >> 3;
+	const uint8_t bit = 1 << (msgNum & 0x7);
+	if (tracked_[idx] & bit)
+	{
+		return true;
+	}
+	else if (numArrivals_ >= MEGA_CAN_RT_MAX_ARRIVAL_STATS)
+	{
+		WARN("can't track arrivals of msg %d. all stats are in use", msgNum);
+		return false;
+	}
+
+	RT_ArrivalStats &stats = arrivals_[numArrivals_];
+	memset(&stats,0,sizeof(stats));
+	stats.msgNum = msgNum;
+	stats.minPeriodUs = 0xFFFFFFFF;
+
+	// publish the entry before the ISR can look for it
+	MC_ATOMIC_START
+	numArrivals_++;
+	tracked_[idx] |= bit;
+	MC_ATOMIC_END
+	return true;
+}
+
+bool
+RealtimeDataListener::arrivalStats(
+		const uint8_t msgNum,
+		RT_ArrivalStats &stats) const
+{
+	for (uint8_t a=0; a<numArrivals_; a++)
+	{
+		if (arrivals_[a].msgNum == msgNum)
+		{
+			MC_ATOMIC_START
+			memcpy(&stats,&arrivals_[a],sizeof(stats));
+			MC_ATOMIC_END
+			return true;
+		}
+	}
+	return false;
+}
+
+void
+RealtimeDataListener::updateArrivals(
+		const uint8_t msgNum,
+		const uint32_t periodUs)
+{
+	RT_ArrivalStats *stats = arrivals_;
+	while (stats->msgNum != msgNum)
+	{
+		stats++;
+	}
+
+	stats->minPeriodUs = (periodUs < stats->minPeriodUs ? periodUs : stats->minPeriodUs);
+	stats->maxPeriodUs = (periodUs > stats->maxPeriodUs ? periodUs : stats->maxPeriodUs);
+
+	// averages move 1/8th of the way towards each new sample. periods are
+	// clamped so they can't overflow in 1/16 us (a stale message that the
+	// sweep hasn't caught yet can be very late)
+	const uint32_t clampedUs = (periodUs > 0x7FFFFFF ? 0x7FFFFFF : periodUs);
+	const int32_t periodQ4 = (int32_t)(clampedUs) << 4;
+	if (stats->numPeriods == 0)
+	{
+		stats->avgPeriodQ4 = periodQ4;
+	}
+	const int32_t dev = periodQ4 - (int32_t)(stats->avgPeriodQ4);
+	stats->avgPeriodQ4 += dev >> 3;
+	stats->jitterQ4 += ((dev < 0 ? -dev : dev) - (int32_t)(stats->jitterQ4)) >> 3;
+
+	if (stats->numPeriods != 0xFFFF)
+	{
+		stats->numPeriods++;
+	}
+}
+#endif
+
+}// namespace - MegaCAN
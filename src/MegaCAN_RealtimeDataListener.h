@@ -0,0 +1,445 @@
+#ifndef MEGACAN_REALTIME_DATA_LISTENER_H_
+#define MEGACAN_REALTIME_DATA_LISTENER_H_
+
+#include "MegaCAN_RealtimeListenerBase.h"
+
+namespace MegaCAN
+{
+
+// how long a realtime message is considered valid after it's received (ms)
+#define MEGA_CAN_RT_DEFAULT_TIMEOUT_MS 500
+
+// number of realtime messages that can have their arrival times tracked
+#define MEGA_CAN_RT_MAX_ARRIVAL_STATS 4
+
+// returned by RealtimeDataListener::age() for messages that aren't fresh
+#define MEGA_CAN_RT_AGE_UNKNOWN 0xFFFF
+
+// max number of signals that can have change callbacks
+#define MEGA_CAN_RT_MAX_WATCHES 4
+
+// the most recent copy of every realtime broadcast message. message N is
+// stored at byte offset N * MEGA_CAN_RT_MSG_SIZE (validated at compile time)
+struct RT_Data
+{
+	RtMsg00_t m0;
+	RtMsg01_t m1;
+	RtMsg02_t m2;
+	RtMsg03_t m3;
+	RtMsg04_t m4;
+	RtMsg05_t m5;
+	RtMsg06_t m6;
+	RtMsg07_t m7;
+	RtMsg08_t m8;
+	RtMsg09_t m9;
+	RtMsg10_t m10;
+	RtMsg11_t m11;
+	RtMsg12_t m12;
+	RtMsg13_t m13;
+	RtMsg14_t m14;
+	RtMsg15_t m15;
+	RtMsg16_t m16;
+	RtMsg17_t m17;
+	RtMsg18_t m18;
+	RtMsg19_t m19;
+	RtMsg20_t m20;
+	RtMsg21_t m21;
+	RtMsg22_t m22;
+	RtMsg23_t m23;
+	RtMsg24_t m24;
+	RtMsg25_t m25;
+	RtMsg26_t m26;
+	RtMsg27_t m27;
+	RtMsg28_t m28;
+	RtMsg29_t m29;
+	RtMsg30_t m30;
+	RtMsg31_t m31;
+	RtMsg32_t m32;
+	RtMsg33_t m33;
+	RtMsg34_t m34;
+	RtMsg35_t m35;
+	RtMsg36_t m36;
+	RtMsg37_t m37;
+	RtMsg38_t m38;
+	RtMsg39_t m39;
+	RtMsg40_t m40;
+	RtMsg41_t m41;
+	RtMsg42_t m42;
+	RtMsg43_t m43;
+	RtMsg44_t m44;
+	RtMsg45_t m45;
+	RtMsg46_t m46;
+	RtMsg47_t m47;
+	RtMsg48_t m48;
+	RtMsg49_t m49;
+	RtMsg50_t m50;
+	RtMsg51_t m51;
+	RtMsg52_t m52;
+	RtMsg53_t m53;
+	RtMsg54_t m54;
+	RtMsg55_t m55;
+	RtMsg56_t m56;
+	RtMsg57_t m57;
+	RtMsg58_t m58;
+	RtMsg59_t m59;
+	RtMsg60_t m60;
+	RtMsg61_t m61;
+	RtMsg62_t m62;
+};
+
+/**
+ * Called from handle() when a watched signal changes by more than its
+ * deadband.
+ *
+ * @param[in] sig
+ * The signal that changed
+ *
+ * @param[in] value
+ * The new raw value of the signal
+ *
+ * @param[in] arg
+ * The user argument given to watchSignal()
+ */
+typedef void (*RT_SignalCallback)(const RT_Signal &sig, int32_t value, void *arg);
+
+/**
+ * Inter-arrival statistics for one realtime message (see
+ * RealtimeDataListener::trackArrivals()). Frames that arrive after the
+ * message went stale start a new measurement rather than count as a period.
+ */
+struct RT_ArrivalStats
+{
+	// the realtime message number these are for
+	uint8_t msgNum;
+
+	// number of periods measured (saturates)
+	uint16_t numPeriods;
+
+	// shortest and longest time between consecutive frames (us)
+	uint32_t minPeriodUs;
+	uint32_t maxPeriodUs;
+
+	// exponentially weighted average period, and average deviation from it
+	// (jitter). both are in 1/16 us.
+	uint32_t avgPeriodQ4;
+	uint32_t jitterQ4;
+
+	float
+	avgPeriodMs() const
+	{
+		return avgPeriodQ4 / 16000.0f;
+	}
+
+	float
+	jitterMs() const
+	{
+		return jitterQ4 / 16000.0f;
+	}
+};
+
+/**
+ * A device that listens for Megasquirt realtime broadcast messages. It stores
+ * and provides access to the most recent engine data received from the bus.
+ *
+ * Broadcast frames are copied into RT_Data directly from the CAN interrupt,
+ * so the copy is kept to a single bounds check plus an 8 byte memcpy.
+ *
+ * The ISR sets a message's dirty bit when its first frame arrives and
+ * whenever a frame changes its contents, so consumers can skip messages
+ * that only received repeats (see takeDirty()). Individual signals can also
+ * be watched with a deadband; their callbacks are run from handle(), never
+ * the ISR.
+ *
+ * Each message has a sequence number that the ISR bumps after updating it
+ * (a seqlock). read() and snapshot() copy a message and retry if its
+ * sequence number changed meanwhile, so multi-byte values are never torn
+ * and interrupts are never disabled.
+ *
+ * With MEGA_CAN_RX_TIMESTAMPS, each message also records when it was
+ * received. A message that isn't received again within the freshness
+ * timeout is marked stale (from handle()), so control code can reject old
+ * sensor data by checking isFresh().
+ */
+class RealtimeDataListener : public RealtimeListenerBase
+{
+public:
+	/**
+	 * @param[in] baseId
+	 * The 11bit identifier of realtime message 0. Megasquirt ECUs broadcast
+	 * from MEGA_CAN_RT_DEFAULT_BASE_ID unless configured otherwise.
+	 */
+	RealtimeDataListener(
+			uint8_t cs,
+			uint8_t myId,
+			uint8_t intPin,
+			CAN_Msg *buff,
+			uint8_t buffSize,
+			uint16_t baseId = MEGA_CAN_RT_DEFAULT_BASE_ID);
+
+	/**
+	 * @return
+	 * The live realtime data. The ISR may update a message while it's being
+	 * read, so multi-byte values should be read through read() or
+	 * snapshot() instead.
+	 */
+	const RT_Data &
+	data() const
+	{
+		return data_;
+	}
+
+	/**
+	 * Copies a single message without tearing.
+	 *
+	 * @param[in] msg
+	 * The message to copy (a member of data(), ie. data().m2)
+	 *
+	 * @return
+	 * A consistent copy of the message
+	 */
+	template <typename MSG_T>
+	MSG_T
+	read(
+			const MSG_T &msg) const
+	{
+		static_assert(sizeof(MSG_T) == MEGA_CAN_RT_MSG_SIZE,
+			"read() only takes realtime messages");
+		MSG_T copy;
+		const uint8_t *src = reinterpret_cast<const uint8_t *>(&msg);
+		copyMsg(
+			(src - reinterpret_cast<const uint8_t *>(&data_)) / MEGA_CAN_RT_MSG_SIZE,
+			reinterpret_cast<uint8_t *>(&copy));
+		return copy;
+	}
+
+	/**
+	 * Copies a range of messages. Each message is consistent within itself
+	 * (messages arrive in separate frames, so no more can be promised).
+	 *
+	 * @param[out] out
+	 * Receives messages first through first + count - 1 (the rest of out is
+	 * left untouched)
+	 *
+	 * @param[in] first
+	 * The first message number to copy
+	 *
+	 * @param[in] count
+	 * The number of messages to copy
+	 */
+	void
+	snapshot(
+			RT_Data &out,
+			const uint8_t first = 0,
+			const uint8_t count = MEGA_CAN_RT_NUM_MSGS) const;
+
+	/**
+	 * @return
+	 * True if the message's contents changed since the last takeDirty()
+	 */
+	bool
+	isDirty(
+			const uint8_t msgNum) const
+	{
+		return msgNum < MEGA_CAN_RT_NUM_MSGS &&
+			(dirty_[msgNum >> 3] & (1 << (msgNum & 0x7)));
+	}
+
+	/**
+	 * Clears the message's dirty bit.
+	 *
+	 * @return
+	 * True if the message's contents changed since the last takeDirty()
+	 */
+	bool
+	takeDirty(
+			const uint8_t msgNum);
+
+	/**
+	 * Calls back (from handle()) whenever a signal moves more than a
+	 * deadband away from the value it was last reported at. The first
+	 * value received is always reported.
+	 *
+	 * @param[in] sig
+	 * The signal to watch
+	 *
+	 * @param[in] deadband
+	 * How far the raw value may move without being reported (0 reports
+	 * every change)
+	 *
+	 * @param[in] callback
+	 * The function to call with the new value
+	 *
+	 * @param[in] arg
+	 * Passed through to the callback
+	 *
+	 * @return
+	 * False if the signal is invalid or MEGA_CAN_RT_MAX_WATCHES signals are
+	 * already watched
+	 */
+	bool
+	watchSignal(
+			const RT_Signal &sig,
+			const uint32_t deadband,
+			RT_SignalCallback callback,
+			void *arg = nullptr);
+
+	/**
+	 * Plans hardware filters that only pass the realtime broadcast messages.
+	 *
+	 * @param[out] plan
+	 * The resulting mask and filter assignment
+	 *
+	 * @return
+	 * True if successful, false otherwise.
+	 */
+	virtual bool
+	planFilters(
+			FilterPlan_t &plan) const override;
+
+#if MEGA_CAN_RX_TIMESTAMPS
+	/**
+	 * @param[in] timeoutMs
+	 * How long a message stays fresh after it's received (ms)
+	 */
+	void
+	setFreshnessTimeout(
+			const uint16_t timeoutMs)
+	{
+		MC_ATOMIC_START
+		timeoutMs_ = timeoutMs;
+		MC_ATOMIC_END
+	}
+
+	/**
+	 * @return
+	 * True if the message was received within the freshness timeout
+	 */
+	bool
+	isFresh(
+			const uint8_t msgNum) const
+	{
+		return msgNum < MEGA_CAN_RT_NUM_MSGS &&
+			(fresh_[msgNum >> 3] & (1 << (msgNum & 0x7)));
+	}
+
+	/**
+	 * @return
+	 * Milliseconds since the message was received, or MEGA_CAN_RT_AGE_UNKNOWN
+	 * if it isn't fresh
+	 */
+	uint16_t
+	age(
+			const uint8_t msgNum) const;
+
+	/**
+	 * Starts tracking inter-arrival statistics for a message.
+	 *
+	 * @return
+	 * False if the message number is invalid or MEGA_CAN_RT_MAX_ARRIVAL_STATS
+	 * messages are already tracked
+	 */
+	bool
+	trackArrivals(
+			const uint8_t msgNum);
+
+	/**
+	 * @param[out] stats
+	 * A copy of the message's inter-arrival statistics
+	 *
+	 * @return
+	 * False if the message isn't tracked
+	 */
+	bool
+	arrivalStats(
+			const uint8_t msgNum,
+			RT_ArrivalStats &stats) const;
+#endif
+
+protected:
+	/**
+	 * Called when a standard 11bit megasquirt broadcast frame is received.
+	 *
+	 * @param[in] id
+	 * The 11bit CAN identifier
+	 *
+	 * @param[in] length
+	 * The number of data bytes in the CAN frame
+	 *
+	 * @param[in] data
+	 * A pointer to the data segment of the CAN frame
+	 */
+	virtual void
+	handleStandard(
+			const uint32_t id,
+			const uint8_t length,
+			uint8_t *data) override;
+
+	// runs signal callbacks, and marks messages that outlived the freshness
+	// timeout as stale
+	virtual void
+	handleDeferred() override;
+
+private:
+	// copies message msgNum into dst, retrying until it's copied untorn
+	void
+	copyMsg(
+			const uint8_t msgNum,
+			uint8_t *dst) const;
+
+	// calls back watched signals whose messages changed
+	void
+	notifyWatches();
+
+#if MEGA_CAN_RX_TIMESTAMPS
+	// called within CAN ISR with the time since the message's last frame
+	void
+	updateArrivals(
+			const uint8_t msgNum,
+			const uint32_t periodUs);
+#endif
+
+	RT_Data data_;
+
+	// bumped by the ISR after each update of a message (see copyMsg())
+	volatile uint8_t seq_[MEGA_CAN_RT_NUM_MSGS];
+
+	// bit N set by the ISR when message N's contents change. dirty_ is
+	// cleared by the application, changed_ by notifyWatches().
+	volatile uint8_t dirty_[(MEGA_CAN_RT_NUM_MSGS + 7) / 8];
+	volatile uint8_t changed_[(MEGA_CAN_RT_NUM_MSGS + 7) / 8];
+	// bit N set once message N has been received at all
+	volatile uint8_t received_[(MEGA_CAN_RT_NUM_MSGS + 7) / 8];
+
+	struct SignalWatch
+	{
+		RT_Signal sig;
+		uint32_t deadband;
+		RT_SignalCallback callback;
+		void *arg;
+		// value the callback was last called with
+		int32_t lastValue;
+		bool reported;
+	};
+	SignalWatch watches_[MEGA_CAN_RT_MAX_WATCHES];
+	uint8_t numWatches_;
+
+#if MEGA_CAN_RX_TIMESTAMPS
+	// receive timestamp of each message's latest frame
+	volatile uint32_t rxTimes_[MEGA_CAN_RT_NUM_MSGS];
+	// bit N set while message N is within the freshness timeout
+	volatile uint8_t fresh_[(MEGA_CAN_RT_NUM_MSGS + 7) / 8];
+	uint16_t timeoutMs_;
+	// MEGA_CAN_TIMESTAMP() of the last staleness sweep
+	uint32_t lastSweep_;
+
+	// bit N set if message N has an entry in arrivals_
+	volatile uint8_t tracked_[(MEGA_CAN_RT_NUM_MSGS + 7) / 8];
+	RT_ArrivalStats arrivals_[MEGA_CAN_RT_MAX_ARRIVAL_STATS];
+	uint8_t numArrivals_;
+#endif
+
+};
+
+}// namespace - MegaCAN
+
+#endif
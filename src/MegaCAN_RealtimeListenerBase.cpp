@@ -0,0 +1,90 @@
+#include "MegaCAN_RealtimeListenerBase.h"
+
+namespace MegaCAN
+{
+
+RealtimeListenerBase::RealtimeListenerBase(
+		uint8_t cs,
+		uint8_t myId,
+		uint8_t intPin,
+		CAN_Msg *buff,
+		uint8_t buffSize,
+		uint16_t baseId)
+ : Device(cs,myId,intPin,buff,buffSize)
+ , baseId_(baseId)
+{
+}
+
+void
+RealtimeListenerBase::getOptions(
+		struct Options *opts)
+{
+	opts->handleStandardMsgsImmediately = true;
+}
+
+void
+RealtimeListenerBase::applyCanFilters(
+		MCP_CAN *can)
+{
+	// only let the stored Megasquirt broadcast frames through
+	FilterPlan_t plan;
+	if (planFilters(plan) && plan.write(can) == MCP2515_OK)
+	{
+		INFO(
+			"filters pass %d unwanted 11bit ids",
+			plan.stdFalseAccepts);
+		return;
+	}
+
+	// handleStandard() still drops anything that isn't stored
+	WARN("failed to plan filters. accepting all 11bit frames");
+	can->init_Mask(0,0,0x00000000);
+	can->init_Filt(0,0,0x00000000);
+	can->init_Filt(1,0,0x00000000);
+	can->init_Mask(1,0,0x00000000);
+	can->init_Filt(2,0,0x00000000);
+	can->init_Filt(3,0,0x00000000);
+	can->init_Filt(4,0,0x00000000);
+	can->init_Filt(5,0,0x00000000);
+}
+
+bool
+RealtimeListenerBase::updateSlot(
+		uint8_t *slot,
+		volatile uint8_t &seq,
+		const uint8_t length,
+		const uint8_t *data,
+		const bool first)
+{
+	const uint8_t size = (length < MEGA_CAN_RT_MSG_SIZE ? length : MEGA_CAN_RT_MSG_SIZE);
+	if ( ! first && memcmp(slot,data,size) == 0)
+	{
+		return false;
+	}
+
+	memcpy(slot,data,size);
+	MC_COMPILER_BARRIER();
+	seq++;
+	return true;
+}
+
+void
+RealtimeListenerBase::copySlot(
+		uint8_t *dst,
+		const uint8_t *slot,
+		const volatile uint8_t &seq)
+{
+	// the writer is the ISR, so it always finishes an update before we run
+	// again. if the sequence number is unchanged across the copy, the ISR
+	// didn't touch the slot while we were copying it.
+	uint8_t startSeq;
+	do
+	{
+		startSeq = seq;
+		MC_COMPILER_BARRIER();
+		memcpy(dst,slot,MEGA_CAN_RT_MSG_SIZE);
+		MC_COMPILER_BARRIER();
+	} while (startSeq != seq);
+}
+
+}// namespace - MegaCAN
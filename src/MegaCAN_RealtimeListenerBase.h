@@ -0,0 +1,160 @@
+#ifndef MEGACAN_REALTIME_LISTENER_BASE_H_
+#define MEGACAN_REALTIME_LISTENER_BASE_H_
+
+#include "MegaCAN_Device.h"
+
+namespace MegaCAN
+{
+
+// default base identifier of the Megasquirt 11bit realtime broadcast
+#define MEGA_CAN_RT_DEFAULT_BASE_ID 1520
+
+// number of realtime broadcast messages (base ID + 0 through base ID + 62)
+#define MEGA_CAN_RT_NUM_MSGS 63
+
+// number of data bytes within each realtime broadcast message
+#define MEGA_CAN_RT_MSG_SIZE 8
+
+/**
+ * What RealtimeDataListener and RealtimeSubsetListener have in common: the
+ * base identifier of the broadcast, the 11bit filter setup, and the
+ * seqlocked message slots that the CAN ISR stores broadcast frames in.
+ *
+ * Each slot has a sequence number that the ISR bumps after updating it.
+ * copySlot() retries until the sequence number is unchanged across the
+ * copy, so multi-byte values are never torn and interrupts are never
+ * disabled.
+ */
+class RealtimeListenerBase : public Device
+{
+public:
+	uint16_t
+	baseId() const
+	{
+		uint16_t baseId;
+		MC_ATOMIC_START
+		baseId = baseId_;
+		MC_ATOMIC_END
+		return baseId;
+	}
+
+	/**
+	 * Changes which 11bit identifier is treated as realtime message 0
+	 * (ie. to listen to an ECU that broadcasts from a non-default base ID).
+	 * If called after init(), follow up with planFilters() and
+	 * applyFilterPlan() so the hardware filters pass the new identifiers.
+	 */
+	void
+	setBaseId(
+			const uint16_t baseId)
+	{
+		MC_ATOMIC_START
+		baseId_ = baseId;
+		MC_ATOMIC_END
+	}
+
+	/**
+	 * Plans hardware filters that only pass the realtime messages that the
+	 * listener stores.
+	 *
+	 * @param[out] plan
+	 * The resulting mask and filter assignment
+	 *
+	 * @return
+	 * True if successful, false otherwise.
+	 */
+	virtual bool
+	planFilters(
+			FilterPlan_t &plan) const = 0;
+
+protected:
+	/**
+	 * @param[in] baseId
+	 * The 11bit identifier of realtime message 0. Megasquirt ECUs broadcast
+	 * from MEGA_CAN_RT_DEFAULT_BASE_ID unless configured otherwise.
+	 */
+	RealtimeListenerBase(
+			uint8_t cs,
+			uint8_t myId,
+			uint8_t intPin,
+			CAN_Msg *buff,
+			uint8_t buffSize,
+			uint16_t baseId);
+
+	// override so we can mark option to handle standard msgs immediately
+	virtual void
+	getOptions(
+			struct Options *opts) override;
+
+	/**
+	 * override this base method so that we can set filters for broadcast
+	 * frame reception (11bit protocol)
+	 */
+	virtual void
+	applyCanFilters(
+			MCP_CAN *can) override;
+
+	/**
+	 * @param[in] id
+	 * The 11bit CAN identifier of a received frame
+	 *
+	 * @return
+	 * The frame's realtime message number, or MEGA_CAN_RT_NUM_MSGS if it
+	 * isn't a realtime broadcast
+	 */
+	uint8_t
+	msgNumOf(
+			const uint32_t id) const
+	{
+		// ids below the base wrap around and fail the bounds check too
+		const uint16_t msgNum = (uint16_t)(id) - baseId_;
+		return (msgNum < MEGA_CAN_RT_NUM_MSGS ? msgNum : MEGA_CAN_RT_NUM_MSGS);
+	}
+
+	/**
+	 * Called within the CAN ISR. Most frames repeat the previous values, so
+	 * a frame is only copied into its slot if it changes the slot's
+	 * contents, or if it's the slot's first frame.
+	 *
+	 * @param[in] slot
+	 * The message's MEGA_CAN_RT_MSG_SIZE bytes of storage
+	 *
+	 * @param[in] seq
+	 * The slot's sequence number. Bumped once the slot is updated.
+	 *
+	 * @param[in] length
+	 * The number of data bytes in the CAN frame
+	 *
+	 * @param[in] data
+	 * A pointer to the data segment of the CAN frame
+	 *
+	 * @param[in] first
+	 * True if the slot hasn't received a frame yet
+	 *
+	 * @return
+	 * True if the slot was updated
+	 */
+	static bool
+	updateSlot(
+			uint8_t *slot,
+			volatile uint8_t &seq,
+			const uint8_t length,
+			const uint8_t *data,
+			const bool first);
+
+	// copies a slot into dst, retrying until it's copied untorn
+	static void
+	copySlot(
+			uint8_t *dst,
+			const uint8_t *slot,
+			const volatile uint8_t &seq);
+
+private:
+	// 11bit identifier of realtime message 0
+	volatile uint16_t baseId_;
+
+};
+
+}// namespace - MegaCAN
+
+#endif
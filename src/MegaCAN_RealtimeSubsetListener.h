@@ -0,0 +1,257 @@
+#ifndef MEGACAN_REALTIME_SUBSET_LISTENER_H_
+#define MEGACAN_REALTIME_SUBSET_LISTENER_H_
+
+#include "MegaCAN_RealtimeListenerBase.h"
+
+namespace MegaCAN
+{
+
+// returned by RT_SubsetIndex::of() for messages that aren't in the subset
+#define MEGA_CAN_RT_NOT_IN_SUBSET 0xFF
+
+/**
+ * Compile-time lookup of where each message of a subset is stored. of() is
+ * constexpr, so lookups of constant message numbers cost nothing, and
+ * runtime lookups unroll into a compare per message.
+ */
+template <uint8_t... MSG_NUMS>
+struct RT_SubsetIndex;
+
+template <>
+struct RT_SubsetIndex<>
+{
+	static constexpr uint8_t
+	of(
+			const uint8_t /*msgNum*/,
+			const uint8_t /*slot*/ = 0)
+	{
+		return MEGA_CAN_RT_NOT_IN_SUBSET;
+	}
+
+	static constexpr bool
+	valid()
+	{
+		return true;
+	}
+};
+
+template <uint8_t FIRST, uint8_t... REST>
+struct RT_SubsetIndex<FIRST,REST...>
+{
+	/**
+	 * @return
+	 * The slot message msgNum is stored in, or MEGA_CAN_RT_NOT_IN_SUBSET
+	 */
+	static constexpr uint8_t
+	of(
+			const uint8_t msgNum,
+			const uint8_t slot = 0)
+	{
+		return msgNum == FIRST ? slot : RT_SubsetIndex<REST...>::of(msgNum,slot + 1);
+	}
+
+	/**
+	 * @return
+	 * True if every message number is in range and listed only once
+	 */
+	static constexpr bool
+	valid()
+	{
+		return FIRST < MEGA_CAN_RT_NUM_MSGS &&
+			RT_SubsetIndex<REST...>::of(FIRST) == MEGA_CAN_RT_NOT_IN_SUBSET &&
+			RT_SubsetIndex<REST...>::valid();
+	}
+};
+
+/**
+ * Like RealtimeDataListener, but for nodes that only need a few of the
+ * realtime broadcast messages. The messages are listed at compile time, ie.
+ *
+ *   // msg00 (rpm) and msg02 (map) only. 16 bytes of data instead of 504
+ *   RealtimeSubsetListener<0,2> rtsl(CAN_CS,CAN_ID,CAN_INT,canBuff,1);
+ *   uint16_t rpm = rtsl.read<0>().rpm();
+ *
+ * Only the listed messages are stored, the hardware filters are planned for
+ * just their identifiers, and the ISR dispatches each frame to its slot
+ * with a compare per listed message. Messages keep their MSG_defn.h types
+ * (see RtMsg<N>), and reads use the same seqlock as RealtimeDataListener.
+ */
+template <uint8_t... MSG_NUMS>
+class RealtimeSubsetListener : public RealtimeListenerBase
+{
+public:
+	// number of messages stored
+	static constexpr uint8_t NUM_MSGS = sizeof...(MSG_NUMS);
+
+	static_assert(NUM_MSGS > 0,
+		"RealtimeSubsetListener needs at least one message");
+	static_assert(RT_SubsetIndex<MSG_NUMS...>::valid(),
+		"subset message numbers must be unique and less than MEGA_CAN_RT_NUM_MSGS");
+
+	/**
+	 * @param[in] baseId
+	 * The 11bit identifier of realtime message 0. Megasquirt ECUs broadcast
+	 * from MEGA_CAN_RT_DEFAULT_BASE_ID unless configured otherwise.
+	 */
+	RealtimeSubsetListener(
+			uint8_t cs,
+			uint8_t myId,
+			uint8_t intPin,
+			CAN_Msg *buff,
+			uint8_t buffSize,
+			uint16_t baseId = MEGA_CAN_RT_DEFAULT_BASE_ID)
+	 : RealtimeListenerBase(cs,myId,intPin,buff,buffSize,baseId)
+	{
+		memset(data_,0,sizeof(data_));
+		memset((void*)(seq_),0,sizeof(seq_));
+		memset((void*)(dirty_),0,sizeof(dirty_));
+		memset((void*)(received_),0,sizeof(received_));
+	}
+
+	/**
+	 * @return
+	 * True if realtime message N is stored by this listener
+	 */
+	static constexpr bool
+	contains(
+			const uint8_t msgNum)
+	{
+		return RT_SubsetIndex<MSG_NUMS...>::of(msgNum) != MEGA_CAN_RT_NOT_IN_SUBSET;
+	}
+
+	/**
+	 * @return
+	 * The live copy of realtime message N. The ISR may update it while it's
+	 * being read, so multi-byte values should be read through read().
+	 */
+	template <uint8_t N>
+	const typename RtMsg<N>::type &
+	msg() const
+	{
+		static_assert(contains(N), "message isn't in the subset");
+		return *reinterpret_cast<const typename RtMsg<N>::type *>(data_[slotOf<N>()]);
+	}
+
+	/**
+	 * @return
+	 * A consistent copy of realtime message N
+	 */
+	template <uint8_t N>
+	typename RtMsg<N>::type
+	read() const
+	{
+		static_assert(contains(N), "message isn't in the subset");
+		typename RtMsg<N>::type copy;
+		copySlot(reinterpret_cast<uint8_t *>(&copy),data_[slotOf<N>()],seq_[slotOf<N>()]);
+		return copy;
+	}
+
+	/**
+	 * Clears message N's dirty bit.
+	 *
+	 * @return
+	 * True if the message's contents changed since the last takeDirty()
+	 */
+	template <uint8_t N>
+	bool
+	takeDirty()
+	{
+		static_assert(contains(N), "message isn't in the subset");
+		const uint8_t idx = slotOf<N>() >> 3;
+		const uint8_t bit = 1 << (slotOf<N>() & 0x7);
+		bool dirty;
+		MC_ATOMIC_START
+		dirty = dirty_[idx] & bit;
+		dirty_[idx] &= ~bit;
+		MC_ATOMIC_END
+		return dirty;
+	}
+
+	/**
+	 * Plans hardware filters that only pass the subset's messages.
+	 *
+	 * @param[out] plan
+	 * The resulting mask and filter assignment
+	 *
+	 * @return
+	 * True if successful, false otherwise.
+	 */
+	virtual bool
+	planFilters(
+			FilterPlan_t &plan) const override
+	{
+		const uint8_t msgNums[] = {MSG_NUMS...};
+		FilterPlanner planner;
+		for (uint8_t i=0; i<NUM_MSGS; i++)
+		{
+			if ( ! planner.acceptStd(baseId() + msgNums[i]))
+			{
+				return false;
+			}
+		}
+		return planner.plan(plan);
+	}
+
+protected:
+	/**
+	 * Called when a standard 11bit megasquirt broadcast frame is received.
+	 *
+	 * @param[in] id
+	 * The 11bit CAN identifier
+	 *
+	 * @param[in] length
+	 * The number of data bytes in the CAN frame
+	 *
+	 * @param[in] data
+	 * A pointer to the data segment of the CAN frame
+	 */
+	virtual void
+	handleStandard(
+			const uint32_t id,
+			const uint8_t length,
+			uint8_t *data) override
+	{
+		const uint8_t msgNum = msgNumOf(id);
+		if (msgNum >= MEGA_CAN_RT_NUM_MSGS)
+		{
+			return;
+		}
+		const uint8_t slot = RT_SubsetIndex<MSG_NUMS...>::of(msgNum);
+		if (slot == MEGA_CAN_RT_NOT_IN_SUBSET)
+		{
+			return;
+		}
+
+		const uint8_t idx = slot >> 3;
+		const uint8_t bit = 1 << (slot & 0x7);
+		if (updateSlot(data_[slot],seq_[slot],length,data,(received_[idx] & bit) == 0))
+		{
+			received_[idx] |= bit;
+			dirty_[idx] |= bit;
+		}
+	}
+
+private:
+	template <uint8_t N>
+	static constexpr uint8_t
+	slotOf()
+	{
+		return RT_SubsetIndex<MSG_NUMS...>::of(N);
+	}
+
+	// the subset's messages, in the order they're listed
+	uint8_t data_[NUM_MSGS][MEGA_CAN_RT_MSG_SIZE];
+
+	// bumped by the ISR after each update of a slot (see copySlot())
+	volatile uint8_t seq_[NUM_MSGS];
+
+	// bit N set by the ISR when slot N's contents change
+	volatile uint8_t dirty_[(NUM_MSGS + 7) / 8];
+	// bit N set once slot N has been received at all
+	volatile uint8_t received_[(NUM_MSGS + 7) / 8];
+
+};
+
+}// namespace - MegaCAN
+
+#endif
@@ -0,0 +1,122 @@
+#include "MegaCAN_Telemetry.h"
+
+#include "EndianUtils.h"
+#include "MegaCAN_Device.h"
+
+#include <string.h>
+
+namespace MegaCAN
+{
+
+CAN_Telemetry::CAN_Telemetry()
+{
+	reset();
+}
+
+void
+CAN_Telemetry::reset()
+{
+	isrTicksMin_ = 0xFFFF;
+	isrTicksMax_ = 0;
+	isrTicksSum_ = 0;
+	isrCount_ = 0;
+	rxFrames_ = 0;
+	txFrames_ = 0;
+	memset((void*)(queueHighWater_),0,sizeof(queueHighWater_));
+	memset((void*)(counters_),0,sizeof(counters_));
+	windowStartMs_ = 0;
+	windowRxFrames_ = 0;
+	windowTxFrames_ = 0;
+	rxFramesPerSec_ = 0;
+	txFramesPerSec_ = 0;
+	reqRxCount_ = 0;
+	reqHandledCount_ = 0;
+	reqTiming_ = false;
+	timedReq_ = 0;
+	reqStartUs_ = 0;
+	memset(reqRspLatency_,0,sizeof(reqRspLatency_));
+}
+
+void
+CAN_Telemetry::onReqHandled(
+		const uint32_t nowUs,
+		const bool responded)
+{
+	reqHandledCount_++;
+	if ( ! reqTiming_ || reqHandledCount_ != timedReq_)
+	{
+		return;
+	}
+	reqTiming_ = false;
+
+	if (responded)
+	{
+		const uint32_t latencyUs = nowUs - reqStartUs_;
+		uint8_t bucket = 0;
+		uint32_t bound = MEGA_CAN_LATENCY_BUCKET0_US;
+		while (bucket < (MEGA_CAN_LATENCY_BUCKETS - 1) && latencyUs >= bound)
+		{
+			bucket++;
+			bound <<= 1;
+		}
+
+		if (reqRspLatency_[bucket] != 0xFFFF)
+		{
+			reqRspLatency_[bucket]++;
+		}
+	}
+}
+
+void
+CAN_Telemetry::updateRates(
+		const uint32_t nowMs)
+{
+	const uint32_t elapsedMs = nowMs - windowStartMs_;
+	if (elapsedMs == 0)
+	{
+		return;
+	}
+
+	uint32_t rxFrames;
+	uint32_t txFrames;
+	MC_ATOMIC_START
+	rxFrames = rxFrames_;
+	txFrames = txFrames_;
+	MC_ATOMIC_END
+
+	const uint32_t rxPerSec = (rxFrames - windowRxFrames_) * 1000 / elapsedMs;
+	const uint32_t txPerSec = (txFrames - windowTxFrames_) * 1000 / elapsedMs;
+	rxFramesPerSec_ = (rxPerSec > 0xFFFF ? 0xFFFF : rxPerSec);
+	txFramesPerSec_ = (txPerSec > 0xFFFF ? 0xFFFF : txPerSec);
+
+	windowStartMs_ = nowMs;
+	windowRxFrames_ = rxFrames;
+	windowTxFrames_ = txFrames;
+}
+
+void
+CAN_Telemetry::snapshot(
+		CAN_TelemetryTable_t &table) const
+{
+	EndianUtils::setBE(table.rxFramesPerSec, rxFramesPerSec_);
+	EndianUtils::setBE(table.txFramesPerSec, txFramesPerSec_);
+	EndianUtils::setBE(table.isrTicksMin, (uint16_t)(isrCount_ ? isrTicksMin_ : 0));
+	EndianUtils::setBE(table.isrTicksMax, (uint16_t)(isrTicksMax_));
+	EndianUtils::setBE(table.isrTicksAvg, (uint16_t)(isrCount_ ? isrTicksSum_ / isrCount_ : 0));
+	for (uint8_t q=0; q<CAN_TELEM_NUM_QUEUES; q++)
+	{
+		table.queueHighWater[q] = queueHighWater_[q];
+	}
+	EndianUtils::setBE(table.rxFrames, (uint32_t)(rxFrames_));
+	EndianUtils::setBE(table.txFrames, (uint32_t)(txFrames_));
+	for (uint8_t c=0; c<CAN_TELEM_NUM_COUNTERS; c++)
+	{
+		EndianUtils::setBE(table.counters[c], (uint32_t)(counters_[c]));
+	}
+	for (uint8_t b=0; b<MEGA_CAN_LATENCY_BUCKETS; b++)
+	{
+		EndianUtils::setBE(table.reqRspLatency[b], reqRspLatency_[b]);
+	}
+}
+
+}// namespace - MegaCAN
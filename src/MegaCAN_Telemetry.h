@@ -0,0 +1,225 @@
+#ifndef MEGACAN_TELEMETRY_H_
+#define MEGACAN_TELEMETRY_H_
+
+#include <stdint.h>
+
+namespace MegaCAN
+{
+
+#define MEGA_CAN_TELEMETRY 1// set to 0 to remove telemetry bookkeeping from the CAN ISR
+
+// number of MSG_REQ to MSG_RSP latency histogram buckets
+#define MEGA_CAN_LATENCY_BUCKETS 8
+
+// upper bound of the first latency bucket (us). each bucket is twice as wide
+// as the one before it, and the last one holds everything longer.
+#define MEGA_CAN_LATENCY_BUCKET0_US 250
+
+// queues that have their high-water mark tracked
+#define CAN_TELEM_RX_QUEUE  0
+#define CAN_TELEM_STD_QUEUE 1
+#define CAN_TELEM_TX_QUEUE  2
+#define CAN_TELEM_NUM_QUEUES 3
+
+// events that have 32bit counters
+#define CAN_TELEM_SW_RX_OVERFLOW      0// main RX queue was full
+#define CAN_TELEM_SW_STD_RX_OVERFLOW  1// standard RX queue was full
+#define CAN_TELEM_SW_MAILBOX_OVERFLOW 2// no mailbox for a standard frame
+#define CAN_TELEM_HW_RX_OVERFLOW      3// RXB0 or RXB1 was overwritten
+#define CAN_TELEM_SW_TX_OVERFLOW      4// TX queue was full
+#define CAN_TELEM_TX_BUFFERS_FULL     5// frame had to wait for a transmit buffer
+#define CAN_TELEM_ISR_OVERRUN         6// ISR ran for a whole timer0 period or more
+#define CAN_TELEM_NUM_COUNTERS 7
+
+// ISR durations this long (TCNT0 ticks) may have spanned more timer0
+// overflows than can be seen, so they're counted as CAN_TELEM_ISR_OVERRUN
+#define CAN_TELEM_ISR_OVERRUN_TICKS 256
+
+/**
+ * The telemetry table as it's served over MSG_REQ (see TABLE_NO_TELEMETRY).
+ * Multi-byte values are big endian like the rest of the Megasquirt protocol.
+ */
+struct CAN_TelemetryTable_t
+{
+	// frame rates over the last complete one second window
+	uint16_t rxFramesPerSec;
+	uint16_t txFramesPerSec;
+
+	// Device::interrupt() duration in TCNT0 ticks (4us with a 16MHz clock).
+	// saturates at CAN_TELEM_ISR_OVERRUN_TICKS
+	uint16_t isrTicksMin;
+	uint16_t isrTicksMax;
+	uint16_t isrTicksAvg;
+
+	// deepest each queue has been (see CAN_TELEM_*_QUEUE)
+	uint8_t queueHighWater[CAN_TELEM_NUM_QUEUES];
+
+	uint32_t rxFrames;
+	uint32_t txFrames;
+
+	// see CAN_TELEM_* event defines
+	uint32_t counters[CAN_TELEM_NUM_COUNTERS];
+
+	// number of sampled MSG_REQs whose MSG_RSP was queued within each bucket
+	uint16_t reqRspLatency[MEGA_CAN_LATENCY_BUCKETS];
+};
+
+/**
+ * Performance bookkeeping for a Device. The on*() methods are cheap enough to
+ * call from within the CAN ISR; everything else is for the main loop.
+ *
+ * MSG_REQ to MSG_RSP latency is sampled: one request is timed at a time, so
+ * requests that arrive while another is being timed aren't timed themselves.
+ */
+class CAN_Telemetry
+{
+public:
+	CAN_Telemetry();
+
+	void
+	reset();
+
+	/**
+	 * @param[in] ticks
+	 * The ISR's duration in TCNT0 ticks
+	 */
+	void
+	onIsr(
+			uint16_t ticks)
+	{
+		if (ticks >= CAN_TELEM_ISR_OVERRUN_TICKS)
+		{
+			ticks = CAN_TELEM_ISR_OVERRUN_TICKS;
+			counters_[CAN_TELEM_ISR_OVERRUN]++;
+		}
+		isrTicksMin_ = (ticks < isrTicksMin_ ? ticks : isrTicksMin_);
+		isrTicksMax_ = (ticks > isrTicksMax_ ? ticks : isrTicksMax_);
+		isrTicksSum_ += ticks;
+		isrCount_++;
+	}
+
+	void
+	onRxFrame()
+	{
+		rxFrames_++;
+	}
+
+	void
+	onTxFrame()
+	{
+		txFrames_++;
+	}
+
+	void
+	onQueueDepth(
+			const uint8_t queue,
+			const uint8_t depth)
+	{
+		if (depth > queueHighWater_[queue])
+		{
+			queueHighWater_[queue] = depth;
+		}
+	}
+
+	void
+	onEvent(
+			const uint8_t counter)
+	{
+		counters_[counter]++;
+	}
+
+	/**
+	 * Called when a MSG_REQ for this device is queued.
+	 *
+	 * @param[in] nowUs
+	 * The micros() time the request was received
+	 */
+	void
+	onReqReceived(
+			const uint32_t nowUs)
+	{
+		reqRxCount_++;
+		if ( ! reqTiming_)
+		{
+			reqTiming_ = true;
+			timedReq_ = reqRxCount_;
+			reqStartUs_ = nowUs;
+		}
+	}
+
+	/**
+	 * Called once the responses to a MSG_REQ are queued. Requests are
+	 * handled in the order they're received, so this matches up with
+	 * onReqReceived(). Must be called with interrupts disabled.
+	 *
+	 * @param[in] nowUs
+	 * The current micros() time
+	 *
+	 * @param[in] responded
+	 * False if the request was dropped (its latency isn't recorded)
+	 */
+	void
+	onReqHandled(
+			const uint32_t nowUs,
+			const bool responded);
+
+	/**
+	 * @return
+	 * True once a second, when updateRates() should be called
+	 */
+	bool
+	rateWindowDone(
+			const uint32_t nowMs) const
+	{
+		return (nowMs - windowStartMs_) >= 1000;
+	}
+
+	/**
+	 * Closes the frame rate window (see rateWindowDone()).
+	 */
+	void
+	updateRates(
+			const uint32_t nowMs);
+
+	/**
+	 * Copies the telemetry into its served (big endian) form. Must be called
+	 * with interrupts disabled.
+	 */
+	void
+	snapshot(
+			CAN_TelemetryTable_t &table) const;
+
+private:
+	volatile uint16_t isrTicksMin_;
+	volatile uint16_t isrTicksMax_;
+	volatile uint32_t isrTicksSum_;
+	volatile uint32_t isrCount_;
+
+	volatile uint32_t rxFrames_;
+	volatile uint32_t txFrames_;
+
+	volatile uint8_t queueHighWater_[CAN_TELEM_NUM_QUEUES];
+	volatile uint32_t counters_[CAN_TELEM_NUM_COUNTERS];
+
+	// frame counts at the start of the rate window
+	uint32_t windowStartMs_;
+	uint32_t windowRxFrames_;
+	uint32_t windowTxFrames_;
+	// frame rates over the last complete window
+	uint16_t rxFramesPerSec_;
+	uint16_t txFramesPerSec_;
+
+	// requests received (by the ISR) and handled (by the main loop)
+	volatile uint8_t reqRxCount_;
+	uint8_t reqHandledCount_;
+	// the request being timed (if reqTiming_ is set) and when it arrived
+	volatile bool reqTiming_;
+	volatile uint8_t timedReq_;
+	volatile uint32_t reqStartUs_;
+	uint16_t reqRspLatency_[MEGA_CAN_LATENCY_BUCKETS];
+
+};
+
+}// namespace - MegaCAN
+
+#endif
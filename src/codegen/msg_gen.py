@@ -42,6 +42,7 @@ def print_group(group, attrs):
     print("")
 
 group_attrs = []
+signals = []
 prev_group = 0
 for line in lines:
     line = line.strip()
@@ -84,4 +85,25 @@ for line in lines:
         'ms2' : ms2
     })
 
+    if description != 'Unused':
+        signals.append((name, group, offset_in_group, size, signed))
+
     prev_group = group
+
+# type traits to look the structs up by message number (the last group in
+# the csv isn't a full message, so it isn't printed above)
+print("// maps a realtime message number to its struct (ie. RtMsg<2>::type is RtMsg02_t)")
+print("template<uint8_t N> struct RtMsg;")
+for group in range(prev_group):
+    print("template<> struct RtMsg<%d> {using type = RtMsg%02d_t;};" % (group, group))
+print("")
+
+# where each signal lives, so RealtimeDataListener users don't have to copy
+# offsets and sizes out of the csv by hand
+print("// location of every realtime signal (ie. for RealtimeDataListener::watchSignal())")
+print("namespace RtSig")
+print("{")
+for name, group, offset, size, signed in signals:
+    if group < prev_group:
+        print("  constexpr RT_Signal %s = {%d,%d,%d,%s};" % (name, group, offset, size, 'true' if signed else 'false'))
+print("}")
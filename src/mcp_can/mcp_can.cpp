@@ -38,6 +38,33 @@ void MCP_CAN::mcp2515_reset(void)
     MCP2515_UNSELECT();
     SPI.endTransaction();
     delay(5); // If the MCP2515 was in sleep mode when the reset command was issued then we need to wait a while for it to reset properly
+
+    // registers are back to their reset values
+    m_canctrl   = 0x87;                                                 /* REQOP = config, CLKEN, CLKPRE*/
+    m_caninte   = 0x00;
+    m_rxbctrl[0] = 0x00;
+    m_rxbctrl[1] = 0x00;
+    m_bfpctrl   = 0x00;
+    m_opMode    = MODE_CONFIG;
+}
+
+/*********************************************************************************************************
+** Function name:           mcp2515_setShadowRegister
+** Descriptions:            Update bits of a register that only software changes. The new value is computed
+**                          from the shadow copy and written (without a read or BIT MODIFY), and nothing is
+**                          sent if the bits already match.
+*********************************************************************************************************/
+void MCP_CAN::mcp2515_setShadowRegister(INT8U &shadow, const INT8U address, const INT8U mask, const INT8U data)
+{
+    const INT8U value = (shadow & ~mask) | (data & mask);
+    if (value == shadow)
+        return;
+
+    shadow = value;
+    mcp2515_setRegister(address, value);
+#if MCP_CAN_VALIDATE_SHADOWS
+    validateShadows();
+#endif
 }
 
 /*********************************************************************************************************
@@ -150,7 +177,7 @@ INT8U MCP_CAN::mcp2515_readStatus(void)
 *********************************************************************************************************/
 void MCP_CAN::setSleepWakeup(const INT8U enable)
 {
-    mcp2515_modifyRegister(MCP_CANINTE, MCP_WAKIF, enable ? MCP_WAKIF : 0);
+    mcp2515_setShadowRegister(m_caninte, MCP_CANINTE, MCP_WAKIF, enable ? MCP_WAKIF : 0);
 }
 
 /*********************************************************************************************************
@@ -169,15 +196,29 @@ INT8U MCP_CAN::setMode(const INT8U opMode)
 *********************************************************************************************************/
 INT8U MCP_CAN::mcp2515_setCANCTRL_Mode(const INT8U newmode)
 {
+	// SLEEP is the only mode the chip leaves on its own (bus activity wakes it into LISTENONLY), so the
+	// shadowed mode only needs to be confirmed over SPI when we think it's asleep
+	const bool wasAsleep = (m_opMode == MCP_SLEEP);
+	if(wasAsleep)
+		m_opMode = mcp2515_readRegister(MCP_CANSTAT) & MODE_MASK;
+
+	if(m_opMode == newmode)
+	{
+		// Clear wake flag
+		if(wasAsleep)
+			mcp2515_modifyRegister(MCP_CANINTF, MCP_WAKIF, 0);
+		return MCP2515_OK;
+	}
+
 	// If the chip is asleep and we want to change mode then a manual wake needs to be done
 	// This is done by setting the wake up interrupt flag
 	// This undocumented trick was found at https://github.com/mkleemann/can/blob/master/can_sleep_mcp2515.c
-	if((mcp2515_readRegister(MCP_CANSTAT) & MODE_MASK) == MCP_SLEEP && newmode != MCP_SLEEP)
+	if(m_opMode == MCP_SLEEP && newmode != MCP_SLEEP)
 	{
 		// Make sure wake interrupt is enabled
-		byte wakeIntEnabled = (mcp2515_readRegister(MCP_CANINTE) & MCP_WAKIF);
+		byte wakeIntEnabled = (m_caninte & MCP_WAKIF);
 		if(!wakeIntEnabled)
-			mcp2515_modifyRegister(MCP_CANINTE, MCP_WAKIF, MCP_WAKIF);
+			mcp2515_setShadowRegister(m_caninte, MCP_CANINTE, MCP_WAKIF, MCP_WAKIF);
 
 		// Set wake flag (this does the actual waking up)
 		mcp2515_modifyRegister(MCP_CANINTF, MCP_WAKIF, MCP_WAKIF);
@@ -193,11 +234,12 @@ INT8U MCP_CAN::mcp2515_setCANCTRL_Mode(const INT8U newmode)
 
 		// Turn wake interrupt back off if it was originally off
 		if(!wakeIntEnabled)
-			mcp2515_modifyRegister(MCP_CANINTE, MCP_WAKIF, 0);
+			mcp2515_setShadowRegister(m_caninte, MCP_CANINTE, MCP_WAKIF, 0);
 	}
 
 	// Clear wake flag
-	mcp2515_modifyRegister(MCP_CANINTF, MCP_WAKIF, 0);
+	if(wasAsleep)
+		mcp2515_modifyRegister(MCP_CANINTF, MCP_WAKIF, 0);
 	
 	return mcp2515_requestNewMode(newmode);
 }
@@ -215,10 +257,12 @@ INT8U MCP_CAN::mcp2515_requestNewMode(const INT8U newmode)
 	{
 		// Request new mode
 		// This is inside the loop as sometimes requesting the new mode once doesn't work (usually when attempting to sleep)
-		mcp2515_modifyRegister(MCP_CANCTRL, MODE_MASK, newmode); 
+		m_canctrl = (m_canctrl & ~MODE_MASK) | newmode;
+		mcp2515_setRegister(MCP_CANCTRL, m_canctrl);
 
 		byte statReg = mcp2515_readRegister(MCP_CANSTAT);
-		if((statReg & MODE_MASK) == newmode) // We're now in the new mode
+		m_opMode = statReg & MODE_MASK;
+		if(m_opMode == newmode) // We're now in the new mode
 			return MCP2515_OK;
 		else if((byte)(millis() - startTime) > 200) // Wait no more than 200ms for the operation to complete
 			return MCP2515_FAIL;
@@ -585,44 +629,44 @@ INT8U MCP_CAN::mcp2515_init(const INT8U canIDMode, const INT8U canSpeed, const I
         mcp2515_initCANBuffers();
 
                                                                         /* interrupt mode               */
-        mcp2515_setRegister(MCP_CANINTE, MCP_RX0IF | MCP_RX1IF);
+        mcp2515_setShadowRegister(m_caninte, MCP_CANINTE, 0xFF, MCP_RX0IF | MCP_RX1IF);
 
 	//Sets BF pins as GPO
-	mcp2515_setRegister(MCP_BFPCTRL,MCP_BxBFS_MASK | MCP_BxBFE_MASK);
+	mcp2515_setShadowRegister(m_bfpctrl, MCP_BFPCTRL, 0xFF, MCP_BxBFS_MASK | MCP_BxBFE_MASK);
 	//Sets RTS pins as GPI
 	mcp2515_setRegister(MCP_TXRTSCTRL,0x00);
 
         switch(canIDMode)
         {
             case (MCP_ANY):
-            mcp2515_modifyRegister(MCP_RXB0CTRL,
+            mcp2515_setShadowRegister(m_rxbctrl[0], MCP_RXB0CTRL,
             MCP_RXB_RX_MASK | MCP_RXB_BUKT_MASK,
             MCP_RXB_RX_ANY | MCP_RXB_BUKT_MASK);
-            mcp2515_modifyRegister(MCP_RXB1CTRL, MCP_RXB_RX_MASK,
+            mcp2515_setShadowRegister(m_rxbctrl[1], MCP_RXB1CTRL, MCP_RXB_RX_MASK,
             MCP_RXB_RX_ANY);
             break;
 /*          The followingn two functions of the MCP2515 do not work, there is a bug in the silicon.
             case (MCP_STD): 
-            mcp2515_modifyRegister(MCP_RXB0CTRL,
+            mcp2515_setShadowRegister(m_rxbctrl[0], MCP_RXB0CTRL,
             MCP_RXB_RX_MASK | MCP_RXB_BUKT_MASK,
             MCP_RXB_RX_STD | MCP_RXB_BUKT_MASK );
-            mcp2515_modifyRegister(MCP_RXB1CTRL, MCP_RXB_RX_MASK,
+            mcp2515_setShadowRegister(m_rxbctrl[1], MCP_RXB1CTRL, MCP_RXB_RX_MASK,
             MCP_RXB_RX_STD);
             break;
 
             case (MCP_EXT): 
-            mcp2515_modifyRegister(MCP_RXB0CTRL,
+            mcp2515_setShadowRegister(m_rxbctrl[0], MCP_RXB0CTRL,
             MCP_RXB_RX_MASK | MCP_RXB_BUKT_MASK,
             MCP_RXB_RX_EXT | MCP_RXB_BUKT_MASK );
-            mcp2515_modifyRegister(MCP_RXB1CTRL, MCP_RXB_RX_MASK,
+            mcp2515_setShadowRegister(m_rxbctrl[1], MCP_RXB1CTRL, MCP_RXB_RX_MASK,
             MCP_RXB_RX_EXT);
             break;
 */
             case (MCP_STDEXT): 
-            mcp2515_modifyRegister(MCP_RXB0CTRL,
+            mcp2515_setShadowRegister(m_rxbctrl[0], MCP_RXB0CTRL,
             MCP_RXB_RX_MASK | MCP_RXB_BUKT_MASK,
             MCP_RXB_RX_STDEXT | MCP_RXB_BUKT_MASK );
-            mcp2515_modifyRegister(MCP_RXB1CTRL, MCP_RXB_RX_MASK,
+            mcp2515_setShadowRegister(m_rxbctrl[1], MCP_RXB1CTRL, MCP_RXB_RX_MASK,
             MCP_RXB_RX_STDEXT);
             break;
     
@@ -655,8 +699,18 @@ INT8U MCP_CAN::mcp2515_init(const INT8U canIDMode, const INT8U canSpeed, const I
 *********************************************************************************************************/
 void MCP_CAN::mcp2515_write_id( const INT8U mcp_addr, const INT8U ext, const INT32U id )
 {
-    uint16_t canid;
     INT8U tbufdata[4];
+    mcp2515_encode_id(ext, id, tbufdata);
+    mcp2515_setRegisterS( mcp_addr, tbufdata, 4 );
+}
+
+/*********************************************************************************************************
+** Function name:           mcp2515_encode_id
+** Descriptions:            Encode a CAN ID into SIDH, SIDL, EID8 and EID0 register values
+*********************************************************************************************************/
+void MCP_CAN::mcp2515_encode_id( const INT8U ext, const INT32U id, INT8U tbufdata[4] )
+{
+    uint16_t canid;
 
     canid = (uint16_t)(id & 0x0FFFF);
 
@@ -677,8 +731,44 @@ void MCP_CAN::mcp2515_write_id( const INT8U mcp_addr, const INT8U ext, const INT
         tbufdata[MCP_EID0] = 0;
         tbufdata[MCP_EID8] = 0;
     }
-    
-    mcp2515_setRegisterS( mcp_addr, tbufdata, 4 );
+}
+
+/*********************************************************************************************************
+** Function name:           mcp2515_load_txbuf
+** Descriptions:            Write ID, DLC and data of a transmit buffer (0 to 2) with a single LOAD TX BUFFER
+**                          transaction. Data is sent straight from the caller's buffer.
+*********************************************************************************************************/
+void MCP_CAN::mcp2515_load_txbuf( const INT8U txbuf, const INT8U ext, const INT32U id, const INT8U dlc, const INT8U *buf )
+{
+    INT8U tbufdata[4];
+    INT8U i;
+    const INT8U len = dlc & MCP_DLC_MASK;
+
+    mcp2515_encode_id(ext, id, tbufdata);
+
+    SPI.beginTransaction(SPISettings(10000000, MSBFIRST, SPI_MODE0));
+    MCP2515_SELECT();
+    spi_readwrite(MCP_LOAD_TX0 + (txbuf << 1));                         /* starts at TXBnSIDH           */
+    for (i=0; i<4; i++)
+        spi_readwrite(tbufdata[i]);
+    spi_readwrite(dlc);
+    for (i=0; i<len; i++)
+        spi_readwrite(buf[i]);
+    MCP2515_UNSELECT();
+    SPI.endTransaction();
+}
+
+/*********************************************************************************************************
+** Function name:           mcp2515_rts
+** Descriptions:            Request to send a transmit buffer (0 to 2) with the one byte RTS instruction
+*********************************************************************************************************/
+void MCP_CAN::mcp2515_rts( const INT8U txbuf )
+{
+    SPI.beginTransaction(SPISettings(10000000, MSBFIRST, SPI_MODE0));
+    MCP2515_SELECT();
+    spi_readwrite(0x80 | (1 << txbuf));                                 /* MCP_RTS_TX0, TX1 or TX2       */
+    MCP2515_UNSELECT();
+    SPI.endTransaction();
 }
 
 /*********************************************************************************************************
@@ -808,7 +898,9 @@ void MCP_CAN::mcp2515_read_canMsg_fast( const INT8U rxbf, INT32U *id, INT8U *ext
         buf[i] = spi_read();
     MCP2515_UNSELECT();
     SPI.endTransaction();
-
+#if MCP_CAN_SPI_STATS
+    m_rxFrames++;
+#endif
 
     *ext = 0;
     *id = (tbufdata[MCP_SIDH]<<3) + (tbufdata[MCP_SIDL]>>5);
@@ -824,27 +916,21 @@ void MCP_CAN::mcp2515_read_canMsg_fast( const INT8U rxbf, INT32U *id, INT8U *ext
 
 /*********************************************************************************************************
 ** Function name:           mcp2515_getNextFreeTXBuf
-** Descriptions:            Send message
+** Descriptions:            Find a transmit buffer (0 to 2) without a pending request from a single READ STATUS
 *********************************************************************************************************/
 INT8U MCP_CAN::mcp2515_getNextFreeTXBuf(INT8U *txbuf_n)                 /* get Next free txbuf          */
 {
-    INT8U res, i, ctrlval;
-    INT8U ctrlregs[MCP_N_TXBUFFERS] = { MCP_TXB0CTRL, MCP_TXB1CTRL, MCP_TXB2CTRL };
+    const INT8U stat = mcp2515_readStatus();
+    const INT8U reqs[MCP_N_TXBUFFERS] = { MCP_STAT_TX0REQ, MCP_STAT_TX1REQ, MCP_STAT_TX2REQ };
 
-    res = MCP_ALLTXBUSY;
     *txbuf_n = 0x00;
-
-                                                                        /* check all 3 TX-Buffers       */
-    for (i=0; i<MCP_N_TXBUFFERS; i++) {
-        ctrlval = mcp2515_readRegister( ctrlregs[i] );
-        if ( (ctrlval & MCP_TXB_TXREQ_M) == 0 ) {
-            *txbuf_n = ctrlregs[i]+1;                                   /* return SIDH-address of Buffer*/
-            
-            res = MCP2515_OK;
-            return res;                                                 /* ! function exit              */
+    for (INT8U i=0; i<MCP_N_TXBUFFERS; i++) {
+        if ( (stat & reqs[i]) == 0 ) {
+            *txbuf_n = i;
+            return MCP2515_OK;                                          /* ! function exit              */
         }
     }
-    return res;
+    return MCP_ALLTXBUSY;
 }
 
 /*********************************************************************************************************
@@ -853,6 +939,8 @@ INT8U MCP_CAN::mcp2515_getNextFreeTXBuf(INT8U *txbuf_n)                 /* get N
 *********************************************************************************************************/
 MCP_CAN::MCP_CAN(INT8U _CS)
 {
+    m_shadowErrors = 0;
+    resetSpiStats();
     MCPCS_bit = digitalPinToBitMask(_CS);
     uint8_t port = digitalPinToPort(_CS);
     MCPCS_out = portOutputRegister(port);
@@ -1097,6 +1185,46 @@ INT8U MCP_CAN::init_Filt(INT8U num, INT32U ulData)
     return res;
 }
 
+/*********************************************************************************************************
+** Function name:           init_MaskFilt
+** Descriptions:            Public function to set both masks and all 6 filters within a single trip
+**                          through configuration mode (ie. to re-filter at runtime). Bit n of extMasks
+**                          and extFilts selects the extended encoding for mask/filter n.
+*********************************************************************************************************/
+INT8U MCP_CAN::init_MaskFilt(const INT32U masks[2], INT8U extMasks, const INT32U filts[6], INT8U extFilts)
+{
+    static const INT8U filtAddrs[6] = {
+        MCP_RXF0SIDH, MCP_RXF1SIDH, MCP_RXF2SIDH,
+        MCP_RXF3SIDH, MCP_RXF4SIDH, MCP_RXF5SIDH};
+
+    INT8U res = mcp2515_setCANCTRL_Mode(MODE_CONFIG);
+    if(res > 0)
+    {
+#if DEBUG_MODE
+      Serial.println(F("Enter Configuration Mode Failure...")); 
+#endif
+      return res;
+    }
+
+    mcp2515_write_mf(MCP_RXM0SIDH, extMasks & 0x1, masks[0]);
+    mcp2515_write_mf(MCP_RXM1SIDH, (extMasks >> 1) & 0x1, masks[1]);
+    for (INT8U i = 0; i < 6; i++)
+    {
+        mcp2515_write_mf(filtAddrs[i], (extFilts >> i) & 0x1, filts[i]);
+    }
+
+    res = mcp2515_setCANCTRL_Mode(mcpMode);
+    if(res > 0)
+    {
+#if DEBUG_MODE
+    Serial.println(F("Entering Previous Mode Failure...")); 
+	Serial.println(F("Setting Mask/Filter Failure..."));
+#endif
+      return res;
+    }
+    return res;
+}
+
 /*********************************************************************************************************
 ** Function name:           setMsg
 ** Descriptions:            Set can message, such as dlc, id, dta[] and so on
@@ -1107,8 +1235,8 @@ INT8U MCP_CAN::setMsg(INT32U id, INT8U rtr, INT8U ext, INT8U len, INT8U *pData)
     m_nID     = id;
     m_nRtr    = rtr;
     m_nExtFlg = ext;
-    m_nDlc    = len;
-    for(i = 0; i<MAX_CHAR_IN_MESSAGE; i++)
+    m_nDlc    = (len > MAX_CHAR_IN_MESSAGE ? MAX_CHAR_IN_MESSAGE : len);
+    for(i = 0; i<m_nDlc; i++)
         m_nDta[i] = *(pData+i);
 	
     return MCP2515_OK;
@@ -1137,11 +1265,21 @@ INT8U MCP_CAN::clearMsg()
 *********************************************************************************************************/
 INT8U MCP_CAN::sendMsg(INT8U waitForSend)
 {
-    INT8U res, res1, txbuf_n;
+    return mcp2515_sendMsg(m_nID, m_nRtr, m_nExtFlg, m_nDlc, m_nDta, waitForSend);
+}
+
+/*********************************************************************************************************
+** Function name:           mcp2515_sendMsg
+** Descriptions:            Send message straight from the caller's buffer. Takes a READ STATUS to find a free
+**                          buffer, a LOAD TX BUFFER and a one byte RTS.
+*********************************************************************************************************/
+INT8U MCP_CAN::mcp2515_sendMsg(INT32U id, INT8U rtr, INT8U ext, INT8U len, const INT8U *buf, INT8U waitForSend)
+{
+    INT8U res, txbuf_n;
     uint16_t uiTimeOut = 0;
 
     do {
-        res = mcp2515_getNextFreeTXBuf(&txbuf_n);                       /* info = addr.                 */
+        res = mcp2515_getNextFreeTXBuf(&txbuf_n);                       /* info = buffer index          */
         uiTimeOut++;
     } while (res == MCP_ALLTXBUSY && (uiTimeOut < TIMEOUTVALUE));
 
@@ -1150,17 +1288,20 @@ INT8U MCP_CAN::sendMsg(INT8U waitForSend)
         return CAN_GETTXBFTIMEOUT;                                      /* get tx buff time out         */
     }
     uiTimeOut = 0;
-    mcp2515_write_canMsg( txbuf_n);
-    mcp2515_modifyRegister( txbuf_n-1 , MCP_TXB_TXREQ_M, MCP_TXB_TXREQ_M );
+
+    if (len > MAX_CHAR_IN_MESSAGE)
+        len = MAX_CHAR_IN_MESSAGE;
+    mcp2515_load_txbuf(txbuf_n, ext, id, (rtr ? len | MCP_RTR_MASK : len), buf);
+    mcp2515_rts(txbuf_n);
     
     if (waitForSend)
     {
+        const INT8U req = MCP_STAT_TX0REQ << (txbuf_n << 1);            /* TX0REQ, TX1REQ, TX2REQ       */
         do
         {
             uiTimeOut++;        
-            res1 = mcp2515_readRegister(txbuf_n-1);                         /* read send buff ctrl reg 	*/
-            res1 = res1 & 0x08;                               		
-        } while (res1 && (uiTimeOut < TIMEOUTVALUE));  
+            res = mcp2515_readStatus() & req;
+        } while (res && (uiTimeOut < TIMEOUTVALUE));  
     }
     
     if(uiTimeOut == TIMEOUTVALUE)                                       /* send msg timeout             */	
@@ -1175,12 +1316,7 @@ INT8U MCP_CAN::sendMsg(INT8U waitForSend)
 *********************************************************************************************************/
 INT8U MCP_CAN::sendMsgBuf(INT32U id, INT8U ext, INT8U len, INT8U *buf, INT8U waitForSend)
 {
-    INT8U res;
-	
-    setMsg(id, 0, ext, len, buf);
-    res = sendMsg(waitForSend);
-    
-    return res;
+    return mcp2515_sendMsg(id, 0, ext, len, buf, waitForSend);
 }
 
 /*********************************************************************************************************
@@ -1190,7 +1326,6 @@ INT8U MCP_CAN::sendMsgBuf(INT32U id, INT8U ext, INT8U len, INT8U *buf, INT8U wai
 INT8U MCP_CAN::sendMsgBuf(INT32U id, INT8U len, INT8U *buf, INT8U waitForSend)
 {
     INT8U ext = 0, rtr = 0;
-    INT8U res;
     
     if((id & 0x80000000) == 0x80000000)
         ext = 1;
@@ -1198,10 +1333,94 @@ INT8U MCP_CAN::sendMsgBuf(INT32U id, INT8U len, INT8U *buf, INT8U waitForSend)
     if((id & 0x40000000) == 0x40000000)
         rtr = 1;
         
-    setMsg(id, rtr, ext, len, buf);
-    res = sendMsg(waitForSend);
-    
-    return res;
+    return mcp2515_sendMsg(id, rtr, ext, len, buf, waitForSend);
+}
+
+/*********************************************************************************************************
+** Function name:           loadTxBuf
+** Descriptions:            Loads a message into the given transmit buffer (0 to 2) and requests it be sent.
+**                          Caller is responsible for tracking which buffers are free (ie. from TXnIF).
+**                          prio is the TXP priority (0 lowest to 3 highest).
+*********************************************************************************************************/
+INT8U MCP_CAN::loadTxBuf(INT8U txbuf, INT8U prio, INT32U id, INT8U ext, INT8U len, const INT8U *buf)
+{
+    if (txbuf >= MCP_N_TXBUFFERS)
+        return CAN_FAILTX;
+
+    const INT8U ctrl = MCP_TXB0CTRL + (txbuf << 4);                     /* TXB0CTRL, TXB1CTRL, TXB2CTRL */
+
+    if (len > CAN_MAX_CHAR_IN_MESSAGE)
+        len = CAN_MAX_CHAR_IN_MESSAGE;
+
+    mcp2515_modifyRegister(ctrl, MCP_TXB_TXP10_M, prio & MCP_TXB_TXP10_M);
+    mcp2515_load_txbuf(txbuf, ext, id, len, buf);
+    mcp2515_rts(txbuf);
+
+    return CAN_OK;
+}
+
+/*********************************************************************************************************
+** Function name:           readTxCtrl
+** Descriptions:            Public function, Reads TXBnCTRL (0 to 2) to see whether a buffer is still pending
+**                          (TXREQ), was aborted (ABTF) or hit bus errors while sending (TXERR, MLOA).
+*********************************************************************************************************/
+INT8U MCP_CAN::readTxCtrl(INT8U txbuf)
+{
+    if (txbuf >= MCP_N_TXBUFFERS)
+        return 0;
+
+    return mcp2515_readRegister(MCP_TXB0CTRL + (txbuf << 4));
+}
+
+/*********************************************************************************************************
+** Function name:           abortTxBuf
+** Descriptions:            Public function, Requests that a single transmit buffer (0 to 2) stop sending. A
+**                          frame already on the wire finishes first, so TXREQ may take a frame time to clear.
+*********************************************************************************************************/
+void MCP_CAN::abortTxBuf(INT8U txbuf)
+{
+    if (txbuf >= MCP_N_TXBUFFERS)
+        return;
+
+    mcp2515_modifyRegister(MCP_TXB0CTRL + (txbuf << 4), MCP_TXB_TXREQ_M, 0);
+}
+
+/*********************************************************************************************************
+** Function name:           setTxInterrupts
+** Descriptions:            Enable or disable the transmit complete interrupts for all 3 transmit buffers
+*********************************************************************************************************/
+void MCP_CAN::setTxInterrupts(INT8U enable)
+{
+    mcp2515_setShadowRegister(m_caninte, MCP_CANINTE, MCP_TX_INT, enable ? MCP_TX_INT : 0);
+}
+
+/*********************************************************************************************************
+** Function name:           setErrorInterrupts
+** Descriptions:            Enable or disable the error (any EFLG condition) and message error interrupts
+*********************************************************************************************************/
+void MCP_CAN::setErrorInterrupts(INT8U enable)
+{
+    mcp2515_setShadowRegister(m_caninte, MCP_CANINTE, MCP_ERR_INT, enable ? MCP_ERR_INT : 0);
+}
+
+/*********************************************************************************************************
+** Function name:           readIntFlags
+** Descriptions:            Public function, Reads CANINTF so an interrupt can be dispatched on its cause(s)
+**                          with a single transaction.
+*********************************************************************************************************/
+INT8U MCP_CAN::readIntFlags(void)
+{
+    return mcp2515_readRegister(MCP_CANINTF);
+}
+
+/*********************************************************************************************************
+** Function name:           clearIntFlags
+** Descriptions:            Public function, Clears CANINTF flags. Receive flags are normally cleared by
+**                          readRxBuf() instead.
+*********************************************************************************************************/
+void MCP_CAN::clearIntFlags(INT8U flags)
+{
+    mcp2515_modifyRegister(MCP_CANINTF, flags, 0);
 }
 
 #define FAST_RXBF_READ
@@ -1242,6 +1461,54 @@ INT8U MCP_CAN::readMsg(INT32U *id, INT8U *ext, INT8U *len, INT8U buf[])
     return res;
 }
 
+/*********************************************************************************************************
+** Function name:           readRxBuf
+** Descriptions:            Public function, Reads a message from RXBn (0 or 1) with a single READ RX BUFFER
+**                          transaction. The MCP2515 releases the buffer when chip select is raised.
+*********************************************************************************************************/
+void MCP_CAN::readRxBuf(INT8U rxbf, INT32U *id, INT8U *ext, INT8U *len, INT8U *buf)
+{
+    mcp2515_read_canMsg_fast(rxbf, id, ext, len, buf);
+}
+
+/*********************************************************************************************************
+** Function name:           getSpiTransactionCount
+** Descriptions:            Public function, Returns the number of SPI transactions since the last reset.
+*********************************************************************************************************/
+INT32U MCP_CAN::getSpiTransactionCount(void)
+{
+#if MCP_CAN_SPI_STATS
+    return m_spiTxns;
+#else
+    return 0;
+#endif
+}
+
+/*********************************************************************************************************
+** Function name:           getRxFrameCount
+** Descriptions:            Public function, Returns the number of frames read since the last reset.
+*********************************************************************************************************/
+INT32U MCP_CAN::getRxFrameCount(void)
+{
+#if MCP_CAN_SPI_STATS
+    return m_rxFrames;
+#else
+    return 0;
+#endif
+}
+
+/*********************************************************************************************************
+** Function name:           resetSpiStats
+** Descriptions:            Public function, Resets the SPI transaction and received frame counts.
+*********************************************************************************************************/
+void MCP_CAN::resetSpiStats(void)
+{
+#if MCP_CAN_SPI_STATS
+    m_spiTxns = 0;
+    m_rxFrames = 0;
+#endif
+}
+
 /*********************************************************************************************************
 ** Function name:           readMsgBuf
 ** Descriptions:            Public function, Reads message from receive buffer.
@@ -1398,11 +1665,8 @@ INT8U MCP_CAN::errorCountTX(void)
 *********************************************************************************************************/
 INT8U MCP_CAN::enOneShotTX(void)                             
 {
-    mcp2515_modifyRegister(MCP_CANCTRL, MODE_ONESHOT, MODE_ONESHOT);
-    if((mcp2515_readRegister(MCP_CANCTRL) & MODE_ONESHOT) != MODE_ONESHOT)
-	    return CAN_FAIL;
-    else
-	    return CAN_OK;
+    mcp2515_setShadowRegister(m_canctrl, MCP_CANCTRL, MODE_ONESHOT, MODE_ONESHOT);
+    return CAN_OK;
 }
 
 /*********************************************************************************************************
@@ -1411,11 +1675,8 @@ INT8U MCP_CAN::enOneShotTX(void)
 *********************************************************************************************************/
 INT8U MCP_CAN::disOneShotTX(void)                             
 {
-    mcp2515_modifyRegister(MCP_CANCTRL, MODE_ONESHOT, 0);
-    if((mcp2515_readRegister(MCP_CANCTRL) & MODE_ONESHOT) != 0)
-        return CAN_FAIL;
-    else
-        return CAN_OK;
+    mcp2515_setShadowRegister(m_canctrl, MCP_CANCTRL, MODE_ONESHOT, 0);
+    return CAN_OK;
 }
 
 /*********************************************************************************************************
@@ -1424,13 +1685,18 @@ INT8U MCP_CAN::disOneShotTX(void)
 *********************************************************************************************************/
 INT8U MCP_CAN::abortTX(void)                             
 {
-    mcp2515_modifyRegister(MCP_CANCTRL, ABORT_TX, ABORT_TX);
-	
-    // Maybe check to see if the TX buffer transmission request bits are cleared instead?
-    if((mcp2515_readRegister(MCP_CANCTRL) & ABORT_TX) != ABORT_TX)
-	    return CAN_FAIL;
-    else
-	    return CAN_OK;
+    mcp2515_setShadowRegister(m_canctrl, MCP_CANCTRL, ABORT_TX, ABORT_TX);
+    return CAN_OK;
+}
+
+/*********************************************************************************************************
+** Function name:           resumeTX
+** Descriptions:            Clears ABAT. New transmissions are aborted for as long as it's set.
+*********************************************************************************************************/
+INT8U MCP_CAN::resumeTX(void)
+{
+    mcp2515_setShadowRegister(m_canctrl, MCP_CANCTRL, ABORT_TX, 0);
+    return CAN_OK;
 }
 
 /*********************************************************************************************************
@@ -1439,7 +1705,7 @@ INT8U MCP_CAN::abortTX(void)
 *********************************************************************************************************/
 INT8U MCP_CAN::setGPO(INT8U data)
 {
-    mcp2515_modifyRegister(MCP_BFPCTRL, MCP_BxBFS_MASK, (data<<4));
+    mcp2515_setShadowRegister(m_bfpctrl, MCP_BFPCTRL, MCP_BxBFS_MASK, (data<<4));
 	    
     return 0;
 }
@@ -1455,6 +1721,49 @@ INT8U MCP_CAN::getGPI(void)
     return (res >> 3);
 }
 
+/*********************************************************************************************************
+** Function name:           validateShadows
+** Descriptions:            Public function, Reads back every shadowed register and compares it against the
+**                          shadow copy (only the bits software controls). Mismatches are counted.
+*********************************************************************************************************/
+INT8U MCP_CAN::validateShadows(void)
+{
+    const INT8U addrs[]   = { MCP_CANCTRL, MCP_CANINTE, MCP_RXB0CTRL, MCP_RXB1CTRL, MCP_BFPCTRL };
+    const INT8U shadows[] = { m_canctrl,   m_caninte,   m_rxbctrl[0], m_rxbctrl[1], m_bfpctrl   };
+    const INT8U masks[]   = { 0xFF,        0xFF,        MCP_RXB_RX_MASK | MCP_RXB_BUKT_MASK,
+                              MCP_RXB_RX_MASK,          MCP_BxBFS_MASK | MCP_BxBFE_MASK | MCP_BxBFM_MASK };
+    INT8U res = MCP2515_OK;
+
+    for (INT8U i=0; i<sizeof(addrs); i++)
+    {
+        if ((mcp2515_readRegister(addrs[i]) & masks[i]) != (shadows[i] & masks[i]))
+            res = MCP2515_FAIL;
+    }
+
+    // the chip can wake itself from sleep, so that mode can't be checked
+    if (m_opMode != MCP_SLEEP && (mcp2515_readRegister(MCP_CANSTAT) & MODE_MASK) != m_opMode)
+        res = MCP2515_FAIL;
+
+    if (res != MCP2515_OK)
+    {
+        if (m_shadowErrors != 0xFF)
+            m_shadowErrors++;
+#if DEBUG_MODE
+        Serial.println(F("Shadow Register Mismatch!"));
+#endif
+    }
+    return res;
+}
+
+/*********************************************************************************************************
+** Function name:           getShadowErrorCount
+** Descriptions:            Public function, Returns the number of failed shadow validations (saturates).
+*********************************************************************************************************/
+INT8U MCP_CAN::getShadowErrorCount(void)
+{
+    return m_shadowErrors;
+}
+
 /*********************************************************************************************************
   END FILE
 *********************************************************************************************************/
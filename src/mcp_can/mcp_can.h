@@ -26,6 +26,14 @@
 
 #define DEBUG_MODE 0
 
+// set to 1 to read back the shadowed configuration registers after every
+// update and count mismatches (see MCP_CAN::validateShadows())
+#define MCP_CAN_VALIDATE_SHADOWS 0
+
+// set to 0 to stop counting SPI transactions and received frames (see
+// MCP_CAN::getSpiTransactionCount())
+#define MCP_CAN_SPI_STATS 1
+
 #include "mcp_can_dfs.h"
 #define MAX_CHAR_IN_MESSAGE 8
 
@@ -58,6 +66,17 @@ class MCP_CAN
     volatile INT8U *MCPCS_out;                                          // Chip Select PORT output register
     INT8U           MCPCS_bit;                                          // Chip Select pin bitmask (used to drive PORT bit high/low)
     INT8U           mcpMode;                                            // Mode to return to after configurations are performed.
+                                                                        // Shadow copies of registers only software changes
+    INT8U           m_canctrl;                                          // CANCTRL
+    INT8U           m_caninte;                                          // CANINTE
+    INT8U           m_rxbctrl[2];                                       // RXB0CTRL, RXB1CTRL (writable bits)
+    INT8U           m_bfpctrl;                                          // BFPCTRL
+    INT8U           m_opMode;                                           // Operating mode last confirmed via CANSTAT
+    INT8U           m_shadowErrors;                                     // Number of failed shadow validations
+#if MCP_CAN_SPI_STATS
+    INT32U          m_spiTxns;                                          // Number of SPI transactions (chip selects)
+    INT32U          m_rxFrames;                                         // Number of frames read from the RX buffers
+#endif
 
 /*********************************************************************************************************
  *  mcp2515 driver function 
@@ -80,6 +99,11 @@ class MCP_CAN
                               const INT8U values[],
                               const INT8U n);
 
+    void mcp2515_setShadowRegister(INT8U &shadow,                       // Set bits of a shadowed register
+                                   const INT8U address,
+                                   const INT8U mask,
+                                   const INT8U data);
+
     void mcp2515_initCANBuffers(void);
 
     void mcp2515_modifyRegister(const INT8U address,                    // Set specific bit(s) of a register
@@ -105,6 +129,18 @@ class MCP_CAN
                            const INT8U ext,
                            const INT32U id );
 
+    void mcp2515_encode_id( const INT8U ext,                            // Encode CAN ID into SIDH, SIDL, EID8, EID0
+                            const INT32U id,
+                            INT8U tbufdata[4] );
+
+    void mcp2515_load_txbuf( const INT8U txbuf,                         // Write ID, DLC & data with LOAD TX BUFFER
+                             const INT8U ext,
+                             const INT32U id,
+                             const INT8U dlc,
+                             const INT8U *buf );
+
+    void mcp2515_rts( const INT8U txbuf );                              // Request to send a transmit buffer
+
     void mcp2515_read_id( const INT8U mcp_addr,                         // Read CAN ID
       INT8U* ext,
                                 INT32U* id );
@@ -113,6 +149,8 @@ class MCP_CAN
     void mcp2515_read_canMsg( const INT8U buffer_sidh_addr, INT32U *id, INT8U *ext, INT8U *len, INT8U buf[]);            // Read CAN message
     void mcp2515_read_canMsg_fast( const INT8U rxbf, INT32U *id, INT8U *ext, INT8U *len, INT8U buf[]);
     INT8U mcp2515_getNextFreeTXBuf(INT8U *txbuf_n);                     // Find empty transmit buffer
+    INT8U mcp2515_sendMsg(INT32U id, INT8U rtr, INT8U ext, INT8U len,   // Send message from caller's buffer
+                          const INT8U *buf, INT8U waitForSend);
 
 /*********************************************************************************************************
  *  CAN operator function
@@ -130,11 +168,26 @@ public:
     INT8U init_Mask(INT8U num, INT32U ulData);                          // Initialize Mask(s)
     INT8U init_Filt(INT8U num, INT8U ext, INT32U ulData);               // Initialize Filter(s)
     INT8U init_Filt(INT8U num, INT32U ulData);                          // Initialize Filter(s)
+    INT8U init_MaskFilt(const INT32U masks[2], INT8U extMasks,          // Initialize both masks and all filters at once
+                        const INT32U filts[6], INT8U extFilts);
     void setSleepWakeup(INT8U enable);                                  // Enable or disable the wake up interrupt (If disabled the MCP2515 will not be woken up by CAN bus activity)
     INT8U setMode(INT8U opMode);                                        // Set operational mode
     INT8U sendMsgBuf(INT32U id, INT8U ext, INT8U len, INT8U *buf, INT8U waitForSend = 1);// Send message to transmit buffer
     INT8U sendMsgBuf(INT32U id, INT8U len, INT8U *buf, INT8U waitForSend = 1);// Send message to transmit buffer
+    INT8U loadTxBuf(INT8U txbuf, INT8U prio, INT32U id, INT8U ext,      // Load message into a specific transmit buffer and request send
+                    INT8U len, const INT8U *buf);
+    INT8U readTxCtrl(INT8U txbuf);                                      // Read TXBnCTRL (see MCP_TXB_*_M)
+    void abortTxBuf(INT8U txbuf);                                       // Abort a single transmit buffer
+    void setTxInterrupts(INT8U enable);                                 // Enable or disable the transmit complete interrupts
+    void setErrorInterrupts(INT8U enable);                              // Enable or disable the ERRIF and MERRF interrupts
+    INT8U readIntFlags(void);                                           // Read CANINTF (the cause of an interrupt)
+    void clearIntFlags(INT8U flags);                                    // Clear CANINTF flags (see MCP_*IF)
     INT8U readMsgBuf(INT32U *id, INT8U *ext, INT8U *len, INT8U *buf);   // Read message from receive buffer
+    void readRxBuf(INT8U rxbf, INT32U *id, INT8U *ext, INT8U *len,      // Read and release RXBn in a single transaction
+                   INT8U *buf);
+    INT32U getSpiTransactionCount(void);                                // SPI transactions since reset (requires MCP_CAN_SPI_STATS)
+    INT32U getRxFrameCount(void);                                       // Frames read since reset (requires MCP_CAN_SPI_STATS)
+    void resetSpiStats(void);                                           // Reset SPI transaction and frame counts
     INT8U readMsgBuf(INT32U *id, INT8U *len, INT8U *buf);               // Read message from receive buffer
     INT8U checkReceive(void);                                           // Check for received data
     INT8U checkError(void);                                             // Check for errors
@@ -145,8 +198,11 @@ public:
     INT8U enOneShotTX(void);                                            // Enable one-shot transmission
     INT8U disOneShotTX(void);                                           // Disable one-shot transmission
     INT8U abortTX(void);                                                // Abort queued transmission(s)
+    INT8U resumeTX(void);                                               // Allow transmissions again after abortTX()
     INT8U setGPO(INT8U data);                                           // Sets GPO
     INT8U getGPI(void);                                                 // Reads GPI
+    INT8U validateShadows(void);                                        // Check shadowed registers against the chip
+    INT8U getShadowErrorCount(void);                                    // Number of failed shadow validations
 };
 
 #endif
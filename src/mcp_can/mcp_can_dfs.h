@@ -79,6 +79,12 @@
 #define MCP_STAT_RXIF_MASK   (0x03)
 #define MCP_STAT_RX0IF       (1<<0)
 #define MCP_STAT_RX1IF       (1<<1)
+#define MCP_STAT_TX0REQ      (1<<2)
+#define MCP_STAT_TX0IF       (1<<3)
+#define MCP_STAT_TX1REQ      (1<<4)
+#define MCP_STAT_TX1IF       (1<<5)
+#define MCP_STAT_TX2REQ      (1<<6)
+#define MCP_STAT_TX2IF       (1<<7)
 
 #define MCP_EFLG_RX1OVR     (1<<7)
 #define MCP_EFLG_RX0OVR     (1<<6)
@@ -156,6 +162,7 @@
 #define MCP_TX_INT          0x1C                                    /* Enable all transmit interrupts  */
 #define MCP_TX01_INT        0x0C                                    /* Enable TXB0 and TXB1 interrupts */
 #define MCP_RX_INT          0x03                                    /* Enable receive interrupts        */
+#define MCP_ERR_INT         0xA0                                    /* Enable error and message error interrupts */
 #define MCP_NO_INT          0x00                                    /* Disable all interrupts           */
 
 #define MCP_TX01_MASK       0x14
@@ -409,7 +416,11 @@
 #define MCP_RXBUF_0 (MCP_RXB0SIDH)
 #define MCP_RXBUF_1 (MCP_RXB1SIDH)
 
+#if MCP_CAN_SPI_STATS
+#define MCP2515_SELECT()   do { m_spiTxns++; *MCPCS_out &= ~MCPCS_bit; } while (0)
+#else
 #define MCP2515_SELECT()   *MCPCS_out &= ~MCPCS_bit
+#endif
 #define MCP2515_UNSELECT() *MCPCS_out |= MCPCS_bit
 
 #define MCP2515_OK         (0)